@@ -146,7 +146,7 @@ namespace jrc
 		if (path == bgmpath)
 			return;
 
-		nl::audio ad = nl::nx::sound.resolve(path);
+		nl::audio ad = nl::nx::sound.resolve_cached(path);
 		auto data = reinterpret_cast<const void*>(ad.data());
 
 		if (data)
@@ -172,7 +172,7 @@ namespace jrc
 		if (path == bgmpath)
 			return;
 
-		nl::audio ad = nl::nx::sound.resolve(path);
+		nl::audio ad = nl::nx::sound.resolve_cached(path);
 		auto data = reinterpret_cast<const void*>(ad.data());
 
 		if (data)
@@ -44,11 +44,10 @@ namespace jrc
 			{
 				for (nl::node partnode : framenode)
 				{
-					std::string part = partnode.name();
+					nl::string_view part = partnode.name_view();
 					if (part != "delay" && part != "face")
 					{
-						std::string z = partnode["z"];
-						Layer layer = layer_by_name(z);
+						Layer layer = layer_by_name(partnode["z"].get_string_view());
 						if (layer == Layer::NONE)
 							continue;
 
@@ -106,19 +105,19 @@ namespace jrc
 	}
 
 
-	Body::Layer Body::layer_by_name(const std::string& name)
+	Body::Layer Body::layer_by_name(nl::string_view name)
 	{
 		auto layer_iter = layers_by_name.find(name);
 		if (layer_iter == layers_by_name.end())
 		{
 			Console::get()
-				.print("Warning: Unhandled body layer (" + name + ")");
+				.print("Warning: Unhandled body layer (" + static_cast<std::string>(name) + ")");
 			return Layer::NONE;
 		}
 		return layer_iter->second;
 	}
 
-	const std::unordered_map<std::string, Body::Layer> Body::layers_by_name =
+	const std::map<std::string, Body::Layer, std::less<>> Body::layers_by_name =
 	{
 		{ "body", Body::BODY },
 		{ "backBody", Body::BODY },
@@ -20,6 +20,10 @@
 
 #include "../../Graphics/Texture.h"
 
+#include "nlnx/string_view.hpp"
+
+#include <map>
+
 namespace jrc
 {
 	class Body
@@ -41,14 +45,15 @@ namespace jrc
 		const std::string& get_name() const;
 
 
-		static Layer layer_by_name(const std::string& name);
+		static Layer layer_by_name(nl::string_view name);
 
 	private:
 		std::unordered_map<uint8_t, Texture> stances[Stance::LENGTH][Layer::NUM_LAYERS];
 		std::string name;
 
 
-		static const std::unordered_map<std::string, Layer> layers_by_name;
+		// Ordered with a transparent comparator, so that it can be searched with a view of a name.
+		static const std::map<std::string, Layer, std::less<>> layers_by_name;
 	};
 }
 
@@ -59,11 +59,10 @@ namespace jrc
 					std::unordered_map<Body::Layer, std::unordered_map<std::string, Point<int16_t>>> bodyshiftmap;
 					for (auto partnode : framenode)
 					{
-						std::string part = partnode.name();
+						nl::string_view part = partnode.name_view();
 						if (part != "delay" && part != "face")
 						{
-							std::string zstr = partnode["z"];
-							Body::Layer z = Body::layer_by_name(zstr);
+							Body::Layer z = Body::layer_by_name(partnode["z"].get_string_view());
 
 							for (auto mapnode : partnode["map"])
 							{
@@ -29,6 +29,18 @@ namespace jrc
 		settings.emplace<Width>();
 		settings.emplace<Height>();
 		settings.emplace<VSync>();
+		settings.emplace<ThreadedRendering>();
+		settings.emplace<TextureStreaming>();
+		settings.emplace<TextureUploadKB>();
+		settings.emplace<TextureUploadCount>();
+		settings.emplace<BitmapCacheMB>();
+		settings.emplace<LayoutCacheSize>();
+		settings.emplace<AtlasPages>();
+		settings.emplace<AtlasPackerType>();
+		settings.emplace<BakedTextureFile>();
+		settings.emplace<DrawStreamFile>();
+		settings.emplace<DrawStreamFrames>();
+		settings.emplace<FrameProfileFile>();
 		settings.emplace<FontPathNormal>();
 		settings.emplace<FontPathBold>();
 		settings.emplace<BGMVolume>();
@@ -234,6 +234,80 @@ namespace jrc
 		VSync() : BoolEntry("VSync", "true") {}
 	};
 
+	// Whether to issue draw calls and swap buffers on a separate render thread.
+	struct ThreadedRendering : public Configuration::BoolEntry
+	{
+		ThreadedRendering() : BoolEntry("ThreadedRendering", "false") {}
+	};
+
+	// Whether to decode textures on worker threads instead of at construction.
+	struct TextureStreaming : public Configuration::BoolEntry
+	{
+		TextureStreaming() : BoolEntry("TextureStreaming", "true") {}
+	};
+
+	// The maximum number of kilobytes of texture data uploaded per frame.
+	struct TextureUploadKB : public Configuration::IntEntry
+	{
+		TextureUploadKB() : IntEntry("TextureUploadKB", "4096") {}
+	};
+
+	// The maximum number of textures uploaded per frame.
+	struct TextureUploadCount : public Configuration::ShortEntry
+	{
+		TextureUploadCount() : ShortEntry("TextureUploadCount", "64") {}
+	};
+
+	// Megabytes of decoded bitmaps kept in memory to avoid decoding them again.
+	struct BitmapCacheMB : public Configuration::IntEntry
+	{
+		BitmapCacheMB() : IntEntry("BitmapCacheMB", "256") {}
+	};
+
+	// The number of text layouts kept, so that texts which are set again do not have to be measured.
+	struct LayoutCacheSize : public Configuration::IntEntry
+	{
+		LayoutCacheSize() : IntEntry("LayoutCacheSize", "2048") {}
+	};
+
+	// The maximum number of 8192x8192 texture atlas pages. Pages are created as they are needed,
+	// and each takes 256 MB of video memory.
+	struct AtlasPages : public Configuration::ByteEntry
+	{
+		AtlasPages() : ByteEntry("AtlasPages", "1") {}
+	};
+
+	// How bitmaps are arranged on an atlas page: "skyline" or "shelf".
+	struct AtlasPackerType : public Configuration::StringEntry
+	{
+		AtlasPackerType() : StringEntry("AtlasPacker", "skyline") {}
+	};
+
+	// File with bitmaps decoded ahead of time by running the client with --bake. Empty to disable.
+	struct BakedTextureFile : public Configuration::StringEntry
+	{
+		BakedTextureFile() : StringEntry("BakedTextureFile", "Textures.bake") {}
+	};
+
+	// File into which the draw calls of every frame are recorded, to be played back with journey_replay. Empty to disable.
+	struct DrawStreamFile : public Configuration::StringEntry
+	{
+		DrawStreamFile() : StringEntry("DrawStreamFile", "") {}
+	};
+
+	// The number of frames to record into the draw stream file, 0 to record until the client is closed.
+	struct DrawStreamFrames : public Configuration::IntEntry
+	{
+		DrawStreamFrames() : IntEntry("DrawStreamFrames", "3600") {}
+	};
+
+	// The name of the csv and json files the frame profile is saved to, without extension.
+	// Leave empty to not save the profile.
+	struct FrameProfileFile : public Configuration::StringEntry
+	{
+		FrameProfileFile() : StringEntry("FrameProfileFile", "") {}
+	};
+
 	// The normal font which will be used.
 	struct FontPathNormal : public Configuration::StringEntry
 	{
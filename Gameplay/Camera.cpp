@@ -116,4 +116,15 @@ namespace jrc
 	{
 		return{ x.get(alpha), y.get(alpha) };
 	}
+
+	Rectangle<int16_t> Camera::area(float alpha) const
+	{
+		Point<int16_t> pos = position(alpha);
+		int16_t left = static_cast<int16_t>(-pos.x());
+		int16_t top = static_cast<int16_t>(-pos.y() - Constants::VIEWYOFFSET);
+		int16_t right = static_cast<int16_t>(left + VWIDTH);
+		int16_t bottom = static_cast<int16_t>(top + VHEIGHT);
+
+		return{ left, right, top, bottom };
+	}
 }
\ No newline at end of file
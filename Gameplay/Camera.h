@@ -19,6 +19,7 @@
 #include "../Template/Interpolated.h"
 #include "../Template/Point.h"
 #include "../Template/Range.h"
+#include "../Template/Rectangle.h"
 
 #include <cstdint>
 
@@ -43,6 +44,8 @@ namespace jrc
 		Point<int16_t> position(float alpha) const;
 		// Return the interpolated position.
 		Point<double> realposition(float alpha) const;
+		// Return the part of the map which is on screen at the interpolated position.
+		Rectangle<int16_t> area(float alpha) const;
 
 	private:
 		// Movement variables.
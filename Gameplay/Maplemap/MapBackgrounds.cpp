@@ -137,6 +137,12 @@ namespace jrc
 		int16_t ix = static_cast<int16_t>(std::round(x));
 		int16_t iy = static_cast<int16_t>(std::round(y));
 
+		DrawArgument args(Point<int16_t>(ix, iy), flipped, opacity / 255);
+
+		// Tiled backgrounds are drawn as one quad which repeats the bitmap, unless they are flipped or overlap.
+		if ((htile > 1 || vtile > 1) && animation.draw_wrapped(args, alpha, { cx, cy }, { htile, vtile }))
+			return;
+
 		int16_t tw = cx * htile;
 		int16_t th = cy * vtile;
 		for (int16_t tx = 0; tx < tw; tx += cx)
@@ -158,7 +164,7 @@ namespace jrc
 	MapBackgrounds::MapBackgrounds(nl::node src)
 	{
 		int16_t no = 0;
-		nl::node back = src[std::to_string(no)];
+		nl::node back = src[no];
 		while (back.size() > 0)
 		{
 			bool front = back["front"].get_bool();
@@ -172,7 +178,7 @@ namespace jrc
 			}
 
 			no++;
-			back = src[std::to_string(no)];
+			back = src[no];
 		}
 
 		black = src["0"]["bS"].get_string() == "";
@@ -44,9 +44,9 @@ namespace jrc
 		mesoicons[BAG] = src["09000003"]["iconRaw"];
 	}
 
-	void MapDrops::draw(Layer::Id layer, double viewx, double viewy, float alpha) const
+	void MapDrops::draw(Layer::Id layer, const Rectangle<int16_t>& area, double viewx, double viewy, float alpha) const
 	{
-		drops.draw(layer, viewx, viewy, alpha);
+		drops.draw(layer, area, viewx, viewy, alpha);
 	}
 
 	void MapDrops::update(const Physics& physics)
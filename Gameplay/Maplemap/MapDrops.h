@@ -34,8 +34,8 @@ namespace jrc
 		// Initialize the meso icons.
 		void init();
 
-		// Draw all drops on a layer.
-		void draw(Layer::Id layer, double viewx, double viewy, float alpha) const;
+		// Draw the drops on a layer which are near the area.
+		void draw(Layer::Id layer, const Rectangle<int16_t>& area, double viewx, double viewy, float alpha) const;
 		// Update all drops.
 		void update(const Physics& physics);
 
@@ -23,9 +23,9 @@
 
 namespace jrc
 {
-	void MapNpcs::draw(Layer::Id layer, double viewx, double viewy, float alpha) const
+	void MapNpcs::draw(Layer::Id layer, const Rectangle<int16_t>& area, double viewx, double viewy, float alpha) const
 	{
-		npcs.draw(layer, viewx, viewy, alpha);
+		npcs.draw(layer, area, viewx, viewy, alpha);
 	}
 
 	void MapNpcs::update(const Physics& physics)
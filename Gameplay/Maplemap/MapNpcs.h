@@ -29,8 +29,8 @@ namespace jrc
 	class MapNpcs
 	{
 	public:
-		// Draw all npcs on a layer.
-		void draw(Layer::Id layer, double viewx, double viewy, float alpha) const;
+		// Draw the npcs on a layer which are near the area.
+		void draw(Layer::Id layer, const Rectangle<int16_t>& area, double viewx, double viewy, float alpha) const;
 		// Update all npcs.
 		void update(const Physics& physics);
 
@@ -17,6 +17,8 @@
 //////////////////////////////////////////////////////////////////////////////
 #include "MapObject.h"
 
+#include <algorithm>
+
 namespace jrc
 {
 	MapObject::MapObject(int32_t o, Point<int16_t> p)
@@ -74,4 +76,53 @@ namespace jrc
 	{
 		return phobj.get_position();
 	}
+
+	Rectangle<int16_t> MapObject::get_area() const
+	{
+		return{ -400, 400, -400, 400 };
+	}
+
+	Rectangle<int16_t> MapObject::get_bounds() const
+	{
+		// Objects are drawn between their last two positions, so the area is widened a little.
+		const int16_t SLACK = 16;
+
+		Rectangle<int16_t> area = get_area();
+		Point<int16_t> position = get_position();
+
+		int16_t left = static_cast<int16_t>(position.x() + area.l() - SLACK);
+		int16_t right = static_cast<int16_t>(position.x() + area.r() + SLACK);
+		int16_t top = static_cast<int16_t>(position.y() + area.t() - SLACK);
+		int16_t bottom = static_cast<int16_t>(position.y() + area.b() + SLACK);
+
+		return{ left, right, top, bottom };
+	}
+
+	Rectangle<int16_t> MapObject::add_area(const Rectangle<int16_t>& area, const Animation& animation)
+	{
+		Rectangle<int16_t> sprites = animation.get_area();
+
+		// A flipped animation reaches as far to the left as the unflipped one reaches to the right.
+		int16_t reach = std::max(sprites.r(), static_cast<int16_t>(-sprites.l()));
+
+		int16_t left = std::min(area.l(), static_cast<int16_t>(-reach));
+		int16_t right = std::max(area.r(), reach);
+		int16_t top = std::min(area.t(), sprites.t());
+		int16_t bottom = std::max(area.b(), sprites.b());
+
+		return{ left, right, top, bottom };
+	}
+
+	Rectangle<int16_t> MapObject::add_nametag(const Rectangle<int16_t>& area)
+	{
+		// Wide enough for long names, and for the function tag of npcs below the name.
+		const int16_t HALFWIDTH = 96;
+		const int16_t HEIGHT = 48;
+
+		int16_t left = std::min(area.l(), static_cast<int16_t>(-HALFWIDTH));
+		int16_t right = std::max(area.r(), HALFWIDTH);
+		int16_t bottom = std::max(area.b(), HEIGHT);
+
+		return{ left, right, area.t(), bottom };
+	}
 }
\ No newline at end of file
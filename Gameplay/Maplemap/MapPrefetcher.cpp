@@ -0,0 +1,94 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#include "MapPrefetcher.h"
+#include "Layer.h"
+
+#include "../../Util/Misc.h"
+
+#include "nlnx/nx.hpp"
+
+#include <exception>
+
+namespace jrc
+{
+	MapPrefetcher::MapPrefetcher()
+	{
+		running = false;
+	}
+
+	MapPrefetcher::~MapPrefetcher()
+	{
+		if (worker.joinable())
+			worker.join();
+	}
+
+	void MapPrefetcher::prefetch(int32_t mapid)
+	{
+		if (running)
+			return;
+
+		if (worker.joinable())
+			worker.join();
+
+		running = true;
+		worker = std::thread(&MapPrefetcher::run, this, mapid);
+	}
+
+	void MapPrefetcher::run(int32_t mapid)
+	{
+		// Prefetching is only a hint, so a file which fails to open is left for the map load to report.
+		try
+		{
+			for (auto& node : collect(mapid))
+				node.prefetch();
+		}
+		catch (const std::exception&) {}
+
+		running = false;
+	}
+
+	std::set<nl::node> MapPrefetcher::collect(int32_t mapid)
+	{
+		std::string strid = string_format::extend_id(mapid, 9);
+		std::string prefix = std::to_string(mapid / 100000000);
+		nl::node src = nl::nx::map["Map"]["Map" + prefix][strid + ".img"];
+
+		// The map itself, followed by the tile, object and background sets it uses.
+		std::set<nl::node> nodes = { src };
+
+		for (auto id : Layer::IDs)
+		{
+			nl::node layer = src[id];
+			std::string tileset = layer["info"]["tS"];
+
+			if (!tileset.empty())
+				nodes.insert(nl::nx::map["Tile"][tileset + ".img"]);
+
+			for (auto objnode : layer["obj"])
+				nodes.insert(nl::nx::map["Obj"][objnode["oS"] + ".img"][objnode["l0"]][objnode["l1"]][objnode["l2"]]);
+		}
+
+		for (auto backnode : src["back"])
+		{
+			bool animated = backnode["ani"].get_bool();
+			nodes.insert(nl::nx::map["Back"][backnode["bS"] + ".img"][animated ? "ani" : "back"][backnode["no"]]);
+		}
+
+		return nodes;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "nlnx/node.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <set>
+#include <thread>
+
+namespace jrc
+{
+	// Reads the game data of a map into memory on a background thread, so that
+	// loading the map after a warp does not wait for the disk.
+	class MapPrefetcher
+	{
+	public:
+		MapPrefetcher();
+		~MapPrefetcher();
+
+		// Start prefetching the map with the given id.
+		// Does nothing while a previous prefetch is still running.
+		void prefetch(int32_t mapid);
+
+		// Return the node of the map with the given id, followed by the tile, object and background sets it uses.
+		static std::set<nl::node> collect(int32_t mapid);
+
+	private:
+		void run(int32_t mapid);
+
+		std::thread worker;
+		std::atomic<bool> running;
+	};
+}
\ No newline at end of file
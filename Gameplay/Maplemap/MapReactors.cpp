@@ -21,9 +21,9 @@
 
 namespace jrc
 {
-	void MapReactors::draw(Layer::Id layer, double viewx, double viewy, float alpha) const
+	void MapReactors::draw(Layer::Id layer, const Rectangle<int16_t>& area, double viewx, double viewy, float alpha) const
 	{
-		reactors.draw(layer, viewx, viewy, alpha);
+		reactors.draw(layer, area, viewx, viewy, alpha);
 	}
 
 	void MapReactors::update(const Physics& physics)
@@ -28,8 +28,8 @@ namespace jrc
 	class MapReactors
 	{
 	public:
-		// Draw all reactors on a layer.
-		void draw(Layer::Id layer, double viewx, double viewy, float alpha) const;
+		// Draw the reactors on a layer which are near the area.
+		void draw(Layer::Id layer, const Rectangle<int16_t>& area, double viewx, double viewy, float alpha) const;
 		// Update all reactors.
 		void update(const Physics& physics);
 
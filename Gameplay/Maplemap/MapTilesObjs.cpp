@@ -21,12 +21,15 @@ namespace jrc
 {
 	TilesObjs::TilesObjs(nl::node src)
 	{
+		std::multimap<uint8_t, Tile> tilemap;
+		std::multimap<uint8_t, Obj> objmap;
+
 		auto tileset = src["info"]["tS"] + ".img";
 		for (auto tilenode : src["tile"])
 		{
 			Tile tile{ tilenode, tileset };
 			int8_t z = tile.getz();
-			tiles.emplace(
+			tilemap.emplace(
 				z, 
 				std::move(tile)
 			);
@@ -36,34 +39,77 @@ namespace jrc
 		{
 			Obj obj{ objnode };
 			int8_t z = obj.getz();
-			objs.emplace(
+			objmap.emplace(
 				z,
 				std::move(obj)
 			);
 		}
+
+		// Tiles and objs which never change are drawn once into batches at their map position,
+		// which are then moved by the camera instead of being drawn again each frame.
+		tiles.begin();
+
+		for (auto& iter : tilemap)
+		{
+			iter.second.draw({});
+		}
+
+		tiles.end();
+
+		for (auto& iter : objmap)
+		{
+			Obj& obj = iter.second;
+
+			if (obj.is_static())
+			{
+				if (objgroups.empty() || objgroups.back().first < objs.size())
+					objgroups.push_back({ StaticBatch(), objs.size() });
+
+				objgroups.back().batch.begin();
+				obj.draw({}, 0.0f);
+				objgroups.back().batch.end();
+			}
+			else
+			{
+				if (objgroups.empty())
+					objgroups.push_back({ StaticBatch(), objs.size() });
+
+				objgrid.insert(objs.size(), obj.get_bounds());
+				objs.push_back(std::move(obj));
+			}
+		}
 	}
 
 	TilesObjs::TilesObjs() {}
 
 	void TilesObjs::update()
 	{
-		for (auto& iter : objs)
+		for (auto& obj : objs)
 		{
-			iter.second.update();
+			obj.update();
 		}
 	}
 
-	void TilesObjs::draw(Point<int16_t> viewpos, float alpha) const
+	void TilesObjs::draw(Point<int16_t> viewpos, const Rectangle<int16_t>& area, float alpha) const
 	{
-		for (auto& iter : objs)
-		{
-			iter.second.draw(viewpos, alpha);
-		}
+		visible.clear();
+		objgrid.query(area, visible);
 
-		for (auto& iter : tiles)
+		auto iter = visible.begin();
+
+		for (size_t i = 0; i < objgroups.size(); i++)
 		{
-			iter.second.draw(viewpos);
+			objgroups[i].batch.draw(viewpos);
+
+			size_t last = i + 1 < objgroups.size() ? objgroups[i + 1].first : objs.size();
+
+			for (; iter != visible.end() && *iter < last; ++iter)
+			{
+				objs[*iter].draw(viewpos, alpha);
+			}
 		}
+
+		tiles.draw(viewpos);
 	}
 
 
@@ -77,10 +123,10 @@ namespace jrc
 
 	MapTilesObjs::MapTilesObjs() {}
 
-	void MapTilesObjs::draw(Layer::Id layer, Point<int16_t> viewpos, float alpha) const
+	void MapTilesObjs::draw(Layer::Id layer, Point<int16_t> viewpos, const Rectangle<int16_t>& area, float alpha) const
 	{
 		layers[layer]
-			.draw(viewpos, alpha);
+			.draw(viewpos, area, alpha);
 	}
 
 	void MapTilesObjs::update()
@@ -20,7 +20,9 @@
 #include "Tile.h"
 #include "Obj.h"
 
+#include "../../Graphics/StaticBatch.h"
 #include "../../Template/EnumMap.h"
+#include "../../Util/SpatialGrid.h"
 
 #include <vector>
 #include <map>
@@ -34,12 +36,24 @@ namespace jrc
 		TilesObjs(nl::node src);
 		TilesObjs();
 
-		void draw(Point<int16_t> viewpos, float alpha) const;
+		// Draw the layer. Only the animated objs which overlap the area are visited.
+		void draw(Point<int16_t> viewpos, const Rectangle<int16_t>& area, float alpha) const;
 		void update();
 
 	private:
-		std::multimap<uint8_t, Tile> tiles;
-		std::multimap<uint8_t, Obj> objs;
+		// A batch of objs which never change, drawn before the animated objs from first on.
+		struct ObjGroup
+		{
+			StaticBatch batch;
+			size_t first;
+		};
+
+		std::vector<ObjGroup> objgroups;
+		std::vector<Obj> objs;
+		SpatialGrid<size_t> objgrid;
+		// The objs found by the last query, kept so that drawing does not allocate.
+		mutable std::vector<size_t> visible;
+		StaticBatch tiles;
 	};
 
 
@@ -50,7 +64,7 @@ namespace jrc
 		MapTilesObjs(nl::node src);
 		MapTilesObjs();
 
-		void draw(Layer::Id layer, Point<int16_t> viewpos, float alpha) const;
+		void draw(Layer::Id layer, Point<int16_t> viewpos, const Rectangle<int16_t>& area, float alpha) const;
 		void update();
 
 	private:
@@ -19,9 +19,9 @@
 
 namespace jrc
 {
-	void MapChars::draw(Layer::Id layer, double viewx, double viewy, float alpha) const
+	void MapChars::draw(Layer::Id layer, const Rectangle<int16_t>& area, double viewx, double viewy, float alpha) const
 	{
-		chars.draw(layer, viewx, viewy, alpha);
+		chars.draw(layer, area, viewx, viewy, alpha);
 	}
 
 	void MapChars::update(const Physics& physics)
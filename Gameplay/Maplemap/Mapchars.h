@@ -31,8 +31,8 @@ namespace jrc
 	class MapChars
 	{
 	public:
-		// Draw all characters on a layer.
-		void draw(Layer::Id layer, double viewx, double viewy, float alpha) const;
+		// Draw the characters on a layer which are near the area.
+		void draw(Layer::Id layer, const Rectangle<int16_t>& area, double viewx, double viewy, float alpha) const;
 		// Update all characters.
 		void update(const Physics& physics);
 
@@ -25,9 +25,9 @@
 
 namespace jrc
 {
-	void MapMobs::draw(Layer::Id layer, double viewx, double viewy, float alpha) const
+	void MapMobs::draw(Layer::Id layer, const Rectangle<int16_t>& area, double viewx, double viewy, float alpha) const
 	{
-		mobs.draw(layer, viewx, viewy, alpha);
+		mobs.draw(layer, area, viewx, viewy, alpha);
 	}
 
 	void MapMobs::update(const Physics& physics)
@@ -30,8 +30,8 @@ namespace jrc
 	class MapMobs
 	{
 	public:
-		// Draw all mobs on a layer.
-		void draw(Layer::Id layer, double viewx, double viewy, float alpha) const;
+		// Draw the mobs on a layer which are near the area.
+		void draw(Layer::Id layer, const Rectangle<int16_t>& area, double viewx, double viewy, float alpha) const;
 		// Update all mobs.
 		void update(const Physics& physics);
 
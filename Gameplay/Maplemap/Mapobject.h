@@ -19,6 +19,9 @@
 #include "../Camera.h"
 #include "../Physics/Physics.h"
 
+#include "../../Graphics/Animation.h"
+#include "../../Template/Rectangle.h"
+
 namespace jrc
 {
 	// Base for objects on a map, eg. mobs, npcs, characters etc.
@@ -51,9 +54,20 @@ namespace jrc
 		// Returns the current position.
 		Point<int16_t> get_position() const;
 
+		// Returns the area the object draws into, relative to its position.
+		// By default a wide area, for objects whose sprites are not known in advance.
+		virtual Rectangle<int16_t> get_area() const;
+		// Returns the area the object draws into on the map.
+		Rectangle<int16_t> get_bounds() const;
+
 	protected:
 		MapObject(int32_t oid, Point<int16_t> position = {});
 
+		// Returns the area extended by an animation which may be drawn flipped.
+		static Rectangle<int16_t> add_area(const Rectangle<int16_t>& area, const Animation& animation);
+		// Returns the area extended by the name tags drawn below the position.
+		static Rectangle<int16_t> add_nametag(const Rectangle<int16_t>& area);
+
 		PhysicsObject phobj;
 		int32_t oid;
 		bool active;
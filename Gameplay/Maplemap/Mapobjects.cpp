@@ -19,9 +19,12 @@
 
 namespace jrc
 {
-	void MapObjects::draw(Layer::Id layer, double viewx, double viewy, float alpha) const
+	void MapObjects::draw(Layer::Id layer, const Rectangle<int16_t>& area, double viewx, double viewy, float alpha) const
 	{
-		for (auto& oid : layers[layer])
+		visible.clear();
+		layers[layer].query(area, visible);
+
+		for (auto& oid : visible)
 		{
 			auto mmo = get(oid);
 			if (mmo && mmo->is_active())
@@ -44,11 +47,20 @@ namespace jrc
 				{
 					remove_mob = true;
 				}
-				else if (newlayer != oldlayer)
+				else
 				{
 					int32_t oid = iter->first;
-					layers[oldlayer].erase(oid);
-					layers[newlayer].insert(oid);
+					Rectangle<int16_t> bounds = mmo->get_bounds();
+
+					if (newlayer != oldlayer)
+					{
+						layers[oldlayer].erase(oid);
+						layers[newlayer].insert(oid, bounds);
+					}
+					else
+					{
+						layers[newlayer].move(oid, bounds);
+					}
 				}
 			}
 			else
@@ -58,6 +70,11 @@ namespace jrc
 
 			if (remove_mob)
 			{
+				for (auto& layer : layers)
+				{
+					layer.erase(iter->first);
+				}
+
 				iter = objects.erase(iter);
 			}
 			else
@@ -86,8 +103,9 @@ namespace jrc
 	{
 		int32_t oid = toadd->get_oid();
 		int8_t layer = toadd->get_layer();
+		Rectangle<int16_t> bounds = toadd->get_bounds();
 		objects[oid] = std::move(toadd);
-		layers[layer].insert(oid);
+		layers[layer].insert(oid, bounds);
 	}
 
 	void MapObjects::remove(int32_t oid)
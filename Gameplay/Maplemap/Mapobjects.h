@@ -20,11 +20,12 @@
 #include "MapObject.h"
 
 #include "../../Template/Optional.h"
+#include "../../Util/SpatialGrid.h"
 
 #include <array>
 #include <memory>
 #include <unordered_map>
-#include <unordered_set>
+#include <vector>
 
 namespace jrc
 {
@@ -32,8 +33,8 @@ namespace jrc
 	class MapObjects
 	{
 	public:
-		// Draw all mapobjects that are on the specified layer.
-		void draw(Layer::Id layer, double viewx, double viewy, float alpha) const;
+		// Draw the mapobjects on the specified layer which are near the area.
+		void draw(Layer::Id layer, const Rectangle<int16_t>& area, double viewx, double viewy, float alpha) const;
 		// Update all mapobjects of this type. Also updates layers eg. drawing order.
 		void update(const Physics& physics);
 
@@ -63,7 +64,10 @@ namespace jrc
 
 	private:
 		std::unordered_map<int32_t, std::unique_ptr<MapObject>> objects;
-		std::array<std::unordered_set<int32_t>, Layer::LENGTH> layers;
+		// Objects are indexed by the area they draw into.
+		std::array<SpatialGrid<int32_t>, Layer::LENGTH> layers;
+		// The objects found by the last query, kept so that drawing does not allocate.
+		mutable std::vector<int32_t> visible;
 	};
 }
 
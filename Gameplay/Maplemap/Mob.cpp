@@ -70,6 +70,11 @@ namespace jrc
 		animations[HIT] = src["hit1"];
 		animations[DIE] = src["die1"];
 
+		for (auto& iter : animations)
+			spritearea = add_area(spritearea, iter.second);
+
+		spritearea = add_nametag(spritearea);
+
 		name = nl::nx::string["Mob.img"][std::to_string(mid)]["name"];
 
 		nl::node sndsrc = nl::nx::sound["Mob.img"][strid];
@@ -352,6 +357,12 @@ namespace jrc
 		effects.drawabove(absp, alpha);
 	}
 
+	Rectangle<int16_t> Mob::get_area() const
+	{
+		// Effects such as those of skills which hit the mob may reach further than its sprites.
+		return effects.empty() ? spritearea : MapObject::get_area();
+	}
+
 	void Mob::set_control(int8_t mode)
 	{
 		control = mode > 0;
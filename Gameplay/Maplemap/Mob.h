@@ -72,6 +72,8 @@ namespace jrc
 		void draw(double viewx, double viewy, float alpha) const override;
 		// Update movement and animations.
 		int8_t update(const Physics& physics) override;
+		// Return the area of the animations, or a wide area while effects are shown.
+		Rectangle<int16_t> get_area() const override;
 
 		// Change this mob's control mode:
 		// 0 - no control, 1 - control, 2 - aggro
@@ -157,6 +159,7 @@ namespace jrc
 		bool canjump;
 		bool canfly;
 
+		Rectangle<int16_t> spritearea;
 		EffectLayer effects;
 		Text namelabel;
 		MobHpBar hpbar;
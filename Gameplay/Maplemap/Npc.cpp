@@ -57,7 +57,7 @@ namespace jrc
 
 			for (auto speaknode : npcnode["speak"])
 			{
-				lines[state].push_back(strsrc[speaknode.get_string()]);
+				lines[state].push_back(strsrc[speaknode]);
 			}
 		}
 
@@ -67,6 +67,11 @@ namespace jrc
 		namelabel = { Text::A13B, Text::CENTER, Text::YELLOW, Text::NAMETAG, name };
 		funclabel = { Text::A13B, Text::CENTER, Text::YELLOW, Text::NAMETAG, func };
 
+		for (auto& iter : animations)
+			spritearea = add_area(spritearea, iter.second);
+
+		spritearea = add_nametag(spritearea);
+
 		npcid = id;
 		flip = !fl;
 		control = cnt;
@@ -90,6 +95,11 @@ namespace jrc
 		}
 	}
 
+	Rectangle<int16_t> Npc::get_area() const
+	{
+		return spritearea;
+	}
+
 	int8_t Npc::update(const Physics& physics)
 	{
 		if (!active)
@@ -42,6 +42,8 @@ namespace jrc
 		void draw(double viewx, double viewy, float alpha) const override;
 		// Updates the current animation and physics.
 		int8_t update(const Physics& physics) override;
+		// Returns the area of the animations and tags.
+		Rectangle<int16_t> get_area() const override;
 
 		// Changes stance and resets animation.
 		void set_stance(const std::string& stance);
@@ -65,6 +67,7 @@ namespace jrc
 		bool flip;
 		std::string stance;
 		bool control;
+		Rectangle<int16_t> spritearea;
 
 		Randomizer random;
 		Text namelabel;
@@ -42,4 +42,21 @@ namespace jrc
 	{
 		return z;
 	}
+
+	bool Obj::is_static() const
+	{
+		return animation.is_static();
+	}
+
+	Rectangle<int16_t> Obj::get_bounds() const
+	{
+		Rectangle<int16_t> area = animation.get_area();
+
+		if (flip)
+			area = { static_cast<int16_t>(-area.r()), static_cast<int16_t>(-area.l()), area.t(), area.b() };
+
+		area.shift(pos);
+
+		return area;
+	}
 }
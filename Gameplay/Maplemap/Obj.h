@@ -33,6 +33,10 @@ namespace jrc
 		void draw(Point<int16_t> viewpos, float inter) const;
 		// Return depth of the obj.
 		uint8_t getz() const;
+		// Whether the obj always looks the same.
+		bool is_static() const;
+		// Return the area on the map which the obj may cover.
+		Rectangle<int16_t> get_bounds() const;
 
 	private:
 		Animation animation;
@@ -30,6 +30,11 @@ namespace jrc
 		nl::node src = nl::nx::reactor[strid + ".img"];
 
 		normal = src["0"];
+
+		// The animation is drawn raised by half its height.
+		Rectangle<int16_t> area = add_area({}, normal);
+		int16_t shift = normal.get_dimensions().y() / 2;
+		spritearea = { area.l(), area.r(), static_cast<int16_t>(area.t() - shift), static_cast<int16_t>(area.b() - shift) };
 	}
 
 	void Reactor::draw(double viewx, double viewy, float alpha) const
@@ -39,6 +44,11 @@ namespace jrc
 		normal.draw(absp - shift, alpha);
 	}
 
+	Rectangle<int16_t> Reactor::get_area() const
+	{
+		return spritearea;
+	}
+
 	void Reactor::destroy(int8_t, Point<int16_t>)
 	{
 		deactivate();
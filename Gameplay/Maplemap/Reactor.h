@@ -31,6 +31,7 @@ namespace jrc
 			int8_t state, Point<int16_t> position);
 
 		void draw(double viewx, double viewy, float alpha) const override;
+		Rectangle<int16_t> get_area() const override;
 
 		void destroy(int8_t state, Point<int16_t> position);
 
@@ -40,5 +41,6 @@ namespace jrc
 		int8_t state;
 
 		Animation normal;
+		Rectangle<int16_t> spritearea;
 	};
 }
\ No newline at end of file
@@ -104,6 +104,7 @@ namespace jrc
 			return;
 
 		Point<int16_t> viewpos = camera.position(alpha);
+		Rectangle<int16_t> viewarea = camera.area(alpha);
 		Point<double> viewrpos = camera.realposition(alpha);
 		double viewx = viewrpos.x();
 		double viewy = viewrpos.y();
@@ -112,13 +113,13 @@ namespace jrc
 
 		for (auto id : Layer::IDs)
 		{
-			tilesobjs.draw(id, viewpos, alpha);
-			reactors.draw(id, viewx, viewy, alpha);
-			npcs.draw(id, viewx, viewy, alpha);
-			mobs.draw(id, viewx, viewy, alpha);
-			chars.draw(id, viewx, viewy, alpha);
+			tilesobjs.draw(id, viewpos, viewarea, alpha);
+			reactors.draw(id, viewarea, viewx, viewy, alpha);
+			npcs.draw(id, viewarea, viewx, viewy, alpha);
+			mobs.draw(id, viewarea, viewx, viewy, alpha);
+			chars.draw(id, viewarea, viewx, viewy, alpha);
 			player.draw(id, viewx, viewy, alpha);
-			drops.draw(id, viewx, viewy, alpha);
+			drops.draw(id, viewarea, viewx, viewy, alpha);
 		}
 
 		combat.draw(viewx, viewy, alpha);
@@ -181,6 +182,9 @@ namespace jrc
 		}
 		else if (warpinfo.valid)
 		{
+			// Start reading the destination map from disk while the server responds.
+			prefetcher.prefetch(warpinfo.mapid);
+
 			PlayerMapTransferPacket().dispatch();
 			ChangeMapPacket(false, warpinfo.mapid, warpinfo.name, false).dispatch();
 
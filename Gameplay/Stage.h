@@ -24,6 +24,7 @@
 #include "Maplemap/MapTilesObjs.h"
 #include "Maplemap/MapBackgrounds.h"
 #include "Maplemap/MapPortals.h"
+#include "Maplemap/MapPrefetcher.h"
 #include "Maplemap/MapChars.h"
 #include "Maplemap/MapMobs.h"
 #include "Maplemap/MapReactors.h"
@@ -118,6 +119,7 @@ namespace jrc
 		MapChars chars;
 		MapMobs mobs;
 		MapDrops drops;
+		MapPrefetcher prefetcher;
 
 		Combat combat;
 	};
@@ -20,6 +20,7 @@
 #include "../Constants.h"
 #include "../Util/Misc.h"
 
+#include <algorithm>
 #include <set>
 
 namespace jrc
@@ -86,6 +87,11 @@ namespace jrc
 		texture.draw(args);
 	}
 
+	bool Frame::draw_wrapped(const DrawArgument& args, Point<int16_t> period, Point<int16_t> count) const
+	{
+		return texture.draw_wrapped(args, period, count);
+	}
+
 	uint8_t Frame::start_opacity() const
 	{
 		return opacities.first;
@@ -146,7 +152,8 @@ namespace jrc
 			{
 				if (sub.data_type() == nl::node::type::bitmap)
 				{
-					int16_t fid = string_conversion::or_default<int16_t>(sub.name(), -1);
+					nl::string_view name = sub.name_view();
+					int16_t fid = string_conversion::or_default<int16_t>(name.data(), name.size(), -1);
 					if (fid >= 0)
 					{
 						frameids.insert(fid);
@@ -156,7 +163,7 @@ namespace jrc
 
 			for (auto& fid : frameids)
 			{
-				auto sub = src[std::to_string(fid)];
+				auto sub = src[fid];
 				frames.push_back(sub);
 			}
 			if (frames.empty())
@@ -206,6 +213,35 @@ namespace jrc
 		}
 	}
 
+	bool Animation::draw_wrapped(const DrawArgument& args, float alpha, Point<int16_t> period, Point<int16_t> count) const
+	{
+		int16_t interframe = frame.get(alpha);
+		float interopc = opacity.get(alpha) / 255;
+		float interscale = xyscale.get(alpha) / 100;
+
+		bool modifyopc = interopc != 1.0f;
+		bool modifyscale = interscale != 1.0f;
+		if (modifyopc || modifyscale)
+		{
+			return frames[interframe].draw_wrapped(args + DrawArgument(interscale, interscale, interopc), period, count);
+		}
+		else
+		{
+			return frames[interframe].draw_wrapped(args, period, count);
+		}
+	}
+
+	bool Animation::is_static() const
+	{
+		if (animated)
+			return false;
+
+		const Frame& first = frames[0];
+
+		return first.start_opacity() == 255 && first.opcstep(1) == 0.0f
+			&& first.start_scale() == 100 && first.scalestep(1) == 0.0f;
+	}
+
 	bool Animation::update()
 	{
 		return update(Constants::TIMESTEP);
@@ -328,6 +364,27 @@ namespace jrc
 		return get_frame().get_bounds();
 	}
 
+	Rectangle<int16_t> Animation::get_area() const
+	{
+		int16_t left = 0;
+		int16_t right = 0;
+		int16_t top = 0;
+		int16_t bottom = 0;
+
+		for (auto& frame : frames)
+		{
+			Point<int16_t> lt = -frame.get_origin();
+			Point<int16_t> rb = lt + frame.get_dimensions();
+
+			left = std::min(left, lt.x());
+			right = std::max(right, rb.x());
+			top = std::min(top, lt.y());
+			bottom = std::max(bottom, rb.y());
+		}
+
+		return{ left, right, top, bottom };
+	}
+
 	const Frame& Animation::get_frame() const
 	{
 		return frames[frame.get()];
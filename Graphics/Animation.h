@@ -33,6 +33,7 @@ namespace jrc
 		Frame();
 
 		void draw(const DrawArgument& args) const;
+		bool draw_wrapped(const DrawArgument& args, Point<int16_t> period, Point<int16_t> count) const;
 
 		uint8_t start_opacity() const;
 		uint16_t start_scale() const;
@@ -66,13 +67,20 @@ namespace jrc
 		void reset();
 		
 		void draw(const DrawArgument& arguments, float inter) const;
+		// Draw count tiles of the current frame, one every period pixels, as a single quad.
+		// Returns false if they have to be drawn one by one.
+		bool draw_wrapped(const DrawArgument& arguments, float inter, Point<int16_t> period, Point<int16_t> count) const;
 
+		// Whether the animation has a single frame which never changes opacity or scale.
+		bool is_static() const;
 		uint16_t get_delay(int16_t frame) const;
 		uint16_t getdelayuntil(int16_t frame) const;
 		Point<int16_t> get_origin() const;
 		Point<int16_t> get_dimensions() const;
 		Point<int16_t> get_head() const;
 		Rectangle<int16_t> get_bounds() const;
+		// Return the area covered by any frame, relative to the position the animation is drawn at.
+		Rectangle<int16_t> get_area() const;
 
 	private:
 		const Frame& get_frame() const;
@@ -0,0 +1,367 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#include "AtlasPacker.h"
+
+#include <chrono>
+#include <iostream>
+
+namespace jrc
+{
+	std::unique_ptr<AtlasPacker> AtlasPacker::create(Type type, int16_t width, int16_t height, int16_t top)
+	{
+		switch (type)
+		{
+		case SHELF:
+			return std::make_unique<ShelfPacker>(width, height, top);
+		default:
+			return std::make_unique<SkylinePacker>(width, height, top);
+		}
+	}
+
+	AtlasPacker::Type AtlasPacker::by_name(const std::string& name)
+	{
+		for (size_t i = 0; i < NUM_TYPES; i++)
+		{
+			Type type = static_cast<Type>(i);
+
+			if (name == get_name(type))
+				return type;
+		}
+
+		return SKYLINE;
+	}
+
+	const char* AtlasPacker::get_name(Type type)
+	{
+		switch (type)
+		{
+		case SHELF:
+			return "shelf";
+		case SKYLINE:
+			return "skyline";
+		default:
+			return "";
+		}
+	}
+
+	void AtlasPacker::benchmark(const std::vector<Point<int16_t>>& sizes, int16_t width, int16_t height)
+	{
+		using clock = std::chrono::steady_clock;
+
+		for (size_t i = 0; i < NUM_TYPES; i++)
+		{
+			Type type = static_cast<Type>(i);
+
+			std::vector<std::unique_ptr<AtlasPacker>> pages;
+			pages.push_back(create(type, width, height, 0));
+
+			size_t area = 0;
+			size_t inserted = 0;
+			clock::duration elapsed{};
+
+			for (auto& size : sizes)
+			{
+				int16_t w = size.x();
+				int16_t h = size.y();
+
+				if (w <= 0 || h <= 0 || w > width || h > height)
+					continue;
+
+				int16_t x = 0;
+				int16_t y = 0;
+
+				auto start = clock::now();
+
+				// Full pages are kept as they are, like an atlas which never evicts.
+				if (!pages.back()->insert(w, h, x, y))
+				{
+					pages.push_back(create(type, width, height, 0));
+					pages.back()->insert(w, h, x, y);
+				}
+
+				elapsed += clock::now() - start;
+
+				area += w * h;
+				inserted++;
+			}
+
+			size_t wasted = 0;
+
+			for (auto& page : pages)
+				wasted += page->get_wasted();
+
+			double fill = 100.0 * area / (static_cast<double>(width) * height * pages.size());
+			double micros = inserted ? std::chrono::duration<double, std::micro>(elapsed).count() / inserted : 0.0;
+
+			std::cout << get_name(type) << ": " << pages.size() << " pages, "
+				<< fill << "% filled, " << wasted << " pixels wasted, "
+				<< micros << " us per insert" << std::endl;
+		}
+	}
+
+	ShelfPacker::ShelfPacker(int16_t w, int16_t h, int16_t t) : width(w), height(h), top(t)
+	{
+		leftovers = QuadTree<size_t, Leftover>(
+			[](const Leftover& first, const Leftover& second)
+			{
+				bool wcomp = first.width() >= second.width();
+				bool hcomp = first.height() >= second.height();
+
+				if (wcomp && hcomp)
+					return QuadTree<size_t, Leftover>::RIGHT;
+				else if (wcomp)
+					return QuadTree<size_t, Leftover>::DOWN;
+				else if (hcomp)
+					return QuadTree<size_t, Leftover>::UP;
+				else
+					return QuadTree<size_t, Leftover>::LEFT;
+			}
+		);
+
+		clear();
+	}
+
+	bool ShelfPacker::insert(int16_t w, int16_t h, int16_t& x, int16_t& y)
+	{
+		auto value = Leftover(0, 0, w, h);
+
+		size_t lid = leftovers.findnode(
+			value,
+			[](const Leftover& val, const Leftover& leaf)
+			{
+				return val.width() <= leaf.width() && val.height() <= leaf.height();
+			}
+		);
+
+		if (lid > 0)
+		{
+			const Leftover& leftover = leftovers[lid];
+
+			x = leftover.l;
+			y = leftover.t;
+
+			int16_t wdelta = leftover.width() - w;
+			int16_t hdelta = leftover.height() - h;
+
+			leftovers.erase(lid);
+
+			wasted -= w * h;
+
+			if (wdelta >= MINLOSIZE && hdelta >= MINLOSIZE)
+			{
+				leftovers.add(rlid, Leftover(x + w, y + h, wdelta, hdelta));
+				rlid++;
+
+				if (w >= MINLOSIZE)
+				{
+					leftovers.add(rlid, Leftover(x, y + h, w, hdelta));
+					rlid++;
+				}
+
+				if (h >= MINLOSIZE)
+				{
+					leftovers.add(rlid, Leftover(x + w, y, wdelta, h));
+					rlid++;
+				}
+			}
+			else if (wdelta >= MINLOSIZE)
+			{
+				leftovers.add(rlid, Leftover(x + w, y, wdelta, h + hdelta));
+				rlid++;
+			}
+			else if (hdelta >= MINLOSIZE)
+			{
+				leftovers.add(rlid, Leftover(x, y + h, w + wdelta, hdelta));
+				rlid++;
+			}
+
+			return true;
+		}
+
+		if (border.x() + w > width)
+		{
+			if (border.y() + yrange.second() + h > height)
+				return false;
+
+			border.set_x(0);
+			border.shift_y(yrange.second());
+			yrange = Range<int16_t>();
+		}
+		else if (border.y() + h > height)
+		{
+			return false;
+		}
+
+		x = border.x();
+		y = border.y();
+
+		border.shift_x(w);
+
+		if (h > yrange.second())
+		{
+			if (x >= MINLOSIZE && h - yrange.second() >= MINLOSIZE)
+			{
+				leftovers.add(rlid, Leftover(0, yrange.first(), x, h - yrange.second()));
+				rlid++;
+			}
+
+			wasted += x * (h - yrange.second());
+
+			yrange = { static_cast<int16_t>(y + h), h };
+		}
+		else if (h < yrange.first() - y)
+		{
+			if (w >= MINLOSIZE && yrange.first() - y - h >= MINLOSIZE)
+			{
+				leftovers.add(rlid, Leftover(x, y + h, w, yrange.first() - y - h));
+				rlid++;
+			}
+
+			wasted += w * (yrange.first() - y - h);
+		}
+
+		return true;
+	}
+
+	void ShelfPacker::clear()
+	{
+		leftovers.clear();
+		rlid = 1;
+		wasted = 0;
+		border = Point<int16_t>(0, top);
+		yrange = Range<int16_t>();
+	}
+
+	size_t ShelfPacker::get_wasted() const
+	{
+		return wasted;
+	}
+
+	SkylinePacker::SkylinePacker(int16_t w, int16_t h, int16_t t) : width(w), height(h), top(t)
+	{
+		clear();
+	}
+
+	bool SkylinePacker::insert(int16_t w, int16_t h, int16_t& x, int16_t& y)
+	{
+		size_t best = skyline.size();
+		int16_t besty = height;
+		int16_t bestw = width;
+
+		for (size_t i = 0; i < skyline.size(); i++)
+		{
+			int16_t fy = fit(i, w, h);
+
+			if (fy < 0)
+				continue;
+
+			// Prefer the lowest bottom edge, then the narrowest segment.
+			if (fy < besty || (fy == besty && skyline[i].w < bestw))
+			{
+				best = i;
+				besty = fy;
+				bestw = skyline[i].w;
+			}
+		}
+
+		if (best == skyline.size())
+			return false;
+
+		x = skyline[best].x;
+		y = besty;
+
+		// The area between the old outline and the bottom of the rectangle can no longer be used.
+		int16_t remaining = w;
+
+		for (size_t i = best; remaining > 0; i++)
+		{
+			int16_t covered_w = std::min(remaining, skyline[i].w);
+			covered += covered_w * static_cast<size_t>(y + h - skyline[i].y);
+			remaining -= covered_w;
+		}
+
+		used += w * h;
+
+		skyline.insert(skyline.begin() + best, { x, static_cast<int16_t>(y + h), w });
+
+		for (size_t i = best + 1; i < skyline.size(); i++)
+		{
+			const Segment& previous = skyline[i - 1];
+			int16_t shrink = static_cast<int16_t>(previous.x + previous.w - skyline[i].x);
+
+			if (shrink <= 0)
+				break;
+
+			skyline[i].x += shrink;
+			skyline[i].w -= shrink;
+
+			if (skyline[i].w > 0)
+				break;
+
+			skyline.erase(skyline.begin() + i);
+			i--;
+		}
+
+		for (size_t i = 0; i + 1 < skyline.size(); i++)
+		{
+			if (skyline[i].y == skyline[i + 1].y)
+			{
+				skyline[i].w += skyline[i + 1].w;
+				skyline.erase(skyline.begin() + i + 1);
+				i--;
+			}
+		}
+
+		return true;
+	}
+
+	int16_t SkylinePacker::fit(size_t index, int16_t w, int16_t h) const
+	{
+		if (skyline[index].x + w > width)
+			return -1;
+
+		int16_t y = skyline[index].y;
+		int16_t remaining = w;
+
+		for (size_t i = index; remaining > 0; i++)
+		{
+			y = std::max(y, skyline[i].y);
+
+			if (y + h > height)
+				return -1;
+
+			remaining -= skyline[i].w;
+		}
+
+		return y;
+	}
+
+	void SkylinePacker::clear()
+	{
+		skyline.clear();
+		skyline.push_back({ 0, top, width });
+
+		used = 0;
+		covered = 0;
+	}
+
+	size_t SkylinePacker::get_wasted() const
+	{
+		return covered - used;
+	}
+}
\ No newline at end of file
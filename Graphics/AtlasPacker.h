@@ -0,0 +1,151 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "../Template/Point.h"
+#include "../Template/Range.h"
+#include "../Util/QuadTree.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace jrc
+{
+	// Finds space for rectangles on one page of the texture atlas.
+	class AtlasPacker
+	{
+	public:
+		enum Type
+		{
+			SHELF,
+			SKYLINE,
+			NUM_TYPES
+		};
+
+		// Create a packer for a page of the given size. The rows above top are kept free.
+		static std::unique_ptr<AtlasPacker> create(Type type, int16_t width, int16_t height, int16_t top);
+		// Return the type with the given name, or the skyline packer if the name is unknown.
+		static Type by_name(const std::string& name);
+		// Return the name of a type.
+		static const char* get_name(Type type);
+
+		// Insert a sequence of rectangle sizes with every type of packer, filling as many pages as needed.
+		// Prints the number of pages, fill rate and average insert time of each.
+		static void benchmark(const std::vector<Point<int16_t>>& sizes, int16_t width, int16_t height);
+
+		virtual ~AtlasPacker() {}
+
+		// Find space for a rectangle. Returns false if it does not fit.
+		virtual bool insert(int16_t w, int16_t h, int16_t& x, int16_t& y) = 0;
+		// Remove all rectangles.
+		virtual void clear() = 0;
+		// Return the area lost to gaps which can no longer be filled.
+		virtual size_t get_wasted() const = 0;
+	};
+
+	// Fills the page in rows, and keeps the space left over below shorter
+	// rectangles in a tree so that it can be filled later.
+	class ShelfPacker : public AtlasPacker
+	{
+	public:
+		ShelfPacker(int16_t width, int16_t height, int16_t top);
+
+		bool insert(int16_t w, int16_t h, int16_t& x, int16_t& y) override;
+		void clear() override;
+		size_t get_wasted() const override;
+
+	private:
+		struct Leftover
+		{
+			int16_t l;
+			int16_t r;
+			int16_t t;
+			int16_t b;
+
+			Leftover(int16_t x, int16_t y, int16_t w, int16_t h)
+			{
+				l = x;
+				r = x + w;
+				t = y;
+				b = y + h;
+			}
+
+			Leftover()
+			{
+				l = 0;
+				r = 0;
+				t = 0;
+				b = 0;
+			}
+
+			int16_t width() const
+			{
+				return r - l;
+			}
+
+			int16_t height() const
+			{
+				return b - t;
+			}
+		};
+
+		static const int16_t MINLOSIZE = 32;
+
+		int16_t width;
+		int16_t height;
+		int16_t top;
+
+		QuadTree<size_t, Leftover> leftovers;
+		size_t rlid;
+		size_t wasted;
+		Point<int16_t> border;
+		Range<int16_t> yrange;
+	};
+
+	// Keeps the outline of the filled area as a list of horizontal segments,
+	// and puts each rectangle where its bottom edge ends up lowest.
+	class SkylinePacker : public AtlasPacker
+	{
+	public:
+		SkylinePacker(int16_t width, int16_t height, int16_t top);
+
+		bool insert(int16_t w, int16_t h, int16_t& x, int16_t& y) override;
+		void clear() override;
+		size_t get_wasted() const override;
+
+	private:
+		struct Segment
+		{
+			int16_t x;
+			int16_t y;
+			int16_t w;
+		};
+
+		// Return the height at which a rectangle fits when its left edge is at the segment, or -1.
+		int16_t fit(size_t index, int16_t w, int16_t h) const;
+
+		int16_t width;
+		int16_t height;
+		int16_t top;
+
+		std::vector<Segment> skyline;
+		size_t used;
+		size_t covered;
+	};
+}
\ No newline at end of file
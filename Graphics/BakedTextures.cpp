@@ -0,0 +1,233 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#include "BakedTextures.h"
+
+#include "nlnx/nx.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <set>
+
+namespace jrc
+{
+	namespace
+	{
+		const char MAGIC[4] = { 'J', 'R', 'C', 'T' };
+
+		void collect(nl::node node, std::vector<nl::bitmap>& bitmaps)
+		{
+			if (node.data_type() == nl::node::type::bitmap)
+				bitmaps.push_back(node);
+
+			for (auto child : node)
+				collect(child, bitmaps);
+		}
+	}
+
+	BakedTextures::BakedTextures() {}
+
+	bool BakedTextures::open(const std::string& filename)
+	{
+		close();
+
+		auto opened = std::make_shared<Contents>();
+
+		if (!opened->file.open(filename))
+			return false;
+
+		const uint8_t* data = opened->file.data();
+		uint64_t size = opened->file.size();
+
+		Header header;
+
+		if (size < sizeof(Header))
+			return false;
+
+		std::memcpy(&header, data, sizeof(Header));
+
+		if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) || header.version != VERSION)
+			return false;
+
+		uint64_t filesbytes = static_cast<uint64_t>(header.files) * sizeof(FileRecord);
+		uint64_t entriesbytes = static_cast<uint64_t>(header.entries) * sizeof(Entry);
+
+		if (sizeof(Header) + filesbytes + entriesbytes > size)
+			return false;
+
+		opened->files.resize(header.files);
+		opened->entries.resize(header.entries);
+
+		std::memcpy(opened->files.data(), data + sizeof(Header), static_cast<size_t>(filesbytes));
+		std::memcpy(opened->entries.data(), data + sizeof(Header) + filesbytes, static_cast<size_t>(entriesbytes));
+
+		std::atomic_store(&contents, std::shared_ptr<const Contents>(std::move(opened)));
+
+		return true;
+	}
+
+	void BakedTextures::close()
+	{
+		std::atomic_store(&contents, std::shared_ptr<const Contents>());
+	}
+
+	BitmapCache::Pixels BakedTextures::load(const nl::bitmap& bmp)
+	{
+		std::shared_ptr<const Contents> current = std::atomic_load(&contents);
+
+		if (!current || current->entries.empty())
+			return nullptr;
+
+		nl::nx::location location;
+
+		if (!nl::nx::locate(reinterpret_cast<const void*>(bmp.id()), location))
+			return nullptr;
+
+		const std::vector<FileRecord>& files = current->files;
+		const std::vector<Entry>& entries = current->entries;
+
+		auto fileiter = std::find_if(files.begin(), files.end(), [&](const FileRecord& record) {
+			return location.name == record.name;
+		});
+
+		if (fileiter == files.end() || fileiter->digest != location.digest)
+			return nullptr;
+
+		Entry key = {};
+		key.file = static_cast<uint32_t>(fileiter - files.begin());
+		key.nxoffset = location.offset;
+
+		auto iter = std::lower_bound(entries.begin(), entries.end(), key);
+
+		if (iter == entries.end() || iter->file != key.file || iter->nxoffset != key.nxoffset)
+			return nullptr;
+
+		if (iter->width != bmp.width() || iter->height != bmp.height())
+			return nullptr;
+
+		uint64_t size = current->file.size();
+		size_t length = bmp.length();
+
+		if (iter->dataoffset > size || length > size - iter->dataoffset)
+			return nullptr;
+
+		const uint8_t* source = current->file.data() + iter->dataoffset;
+
+		return std::make_shared<std::vector<uint8_t>>(source, source + length);
+	}
+
+	size_t BakedTextures::bake(const std::string& filename, const std::vector<nl::node>& roots)
+	{
+		std::vector<nl::bitmap> bitmaps;
+
+		for (auto& root : roots)
+			collect(root, bitmaps);
+
+		std::vector<FileRecord> files;
+		std::vector<std::pair<Entry, nl::bitmap>> baked;
+		std::set<size_t> ids;
+
+		for (auto& bmp : bitmaps)
+		{
+			if (bmp.width() == 0 || bmp.height() == 0)
+				continue;
+
+			if (!ids.insert(bmp.id()).second)
+				continue;
+
+			nl::nx::location location;
+
+			if (!nl::nx::locate(reinterpret_cast<const void*>(bmp.id()), location))
+				continue;
+
+			if (location.name.size() >= sizeof(FileRecord::name))
+				continue;
+
+			auto fileiter = std::find_if(files.begin(), files.end(), [&](const FileRecord& record) {
+				return location.name == record.name;
+			});
+
+			if (fileiter == files.end())
+			{
+				FileRecord record = {};
+				std::strcpy(record.name, location.name.c_str());
+				record.digest = location.digest;
+
+				fileiter = files.insert(files.end(), record);
+			}
+
+			Entry entry = {};
+			entry.nxoffset = location.offset;
+			entry.file = static_cast<uint32_t>(fileiter - files.begin());
+			entry.width = bmp.width();
+			entry.height = bmp.height();
+
+			baked.emplace_back(entry, bmp);
+		}
+
+		std::sort(baked.begin(), baked.end(), [](const std::pair<Entry, nl::bitmap>& first, const std::pair<Entry, nl::bitmap>& second) {
+			return first.first < second.first;
+		});
+
+		auto align = [](uint64_t offset) {
+			return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+		};
+
+		uint64_t offset = align(sizeof(Header) + files.size() * sizeof(FileRecord) + baked.size() * sizeof(Entry));
+
+		for (auto& pair : baked)
+		{
+			pair.first.dataoffset = offset;
+			offset = align(offset + pair.second.length());
+		}
+
+		std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+
+		if (!out)
+			return 0;
+
+		Header header;
+		std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+		header.version = VERSION;
+		header.files = static_cast<uint32_t>(files.size());
+		header.entries = static_cast<uint32_t>(baked.size());
+
+		out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+		out.write(reinterpret_cast<const char*>(files.data()), files.size() * sizeof(FileRecord));
+
+		for (auto& pair : baked)
+			out.write(reinterpret_cast<const char*>(&pair.first), sizeof(Entry));
+
+		std::vector<char> pixels;
+
+		for (auto& pair : baked)
+		{
+			uint64_t written = static_cast<uint64_t>(out.tellp());
+			std::vector<char> padding(static_cast<size_t>(pair.first.dataoffset - written));
+			out.write(padding.data(), padding.size());
+
+			pixels.resize(pair.second.length());
+			pair.second.decode(pixels.data());
+
+			out.write(pixels.data(), pixels.size());
+		}
+
+		return out ? baked.size() : 0;
+	}
+}
\ No newline at end of file
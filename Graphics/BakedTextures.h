@@ -0,0 +1,101 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "BitmapCache.h"
+
+#include "../Util/MappedFile.h"
+
+#include "nlnx/bitmap.hpp"
+#include "nlnx/node.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace jrc
+{
+	// Bitmaps which were decoded offline and stored in a sidecar file, so that
+	// they can be read straight into the atlas without decompressing them.
+	// Entries are keyed by the offset of the bitmap in its nx file and are only
+	// used while the digest of that file still matches the one they were baked from.
+	// The file is memory mapped, so it can be read from multiple threads without locking.
+	class BakedTextures
+	{
+	public:
+		BakedTextures();
+
+		// Open a baked file. Returns false if it does not exist or has the wrong format.
+		bool open(const std::string& filename);
+		// Close the baked file.
+		void close();
+
+		// Return the pixels of a bitmap, or null if it was not baked.
+		BitmapCache::Pixels load(const nl::bitmap& bmp);
+
+		// Decode all bitmaps below the given nodes into a baked file.
+		// Returns the number of bitmaps written.
+		static size_t bake(const std::string& filename, const std::vector<nl::node>& roots);
+
+	private:
+		struct Header
+		{
+			char magic[4];
+			uint32_t version;
+			uint32_t files;
+			uint32_t entries;
+		};
+
+		struct FileRecord
+		{
+			char name[64];
+			uint64_t digest;
+		};
+
+		// Sorted by file, then by offset in that file.
+		struct Entry
+		{
+			uint64_t nxoffset;
+			uint64_t dataoffset;
+			uint32_t file;
+			uint16_t width;
+			uint16_t height;
+
+			bool operator <(const Entry& other) const
+			{
+				return file < other.file || (file == other.file && nxoffset < other.nxoffset);
+			}
+		};
+
+		// An opened file with copies of its tables.
+		struct Contents
+		{
+			MappedFile file;
+			std::vector<FileRecord> files;
+			std::vector<Entry> entries;
+		};
+
+		static const uint32_t VERSION = 1;
+		// Pixel data starts on page boundaries of the mapped file.
+		static const uint64_t ALIGNMENT = 4096;
+
+		// Replaced as a whole by open and close. Each load holds on to the contents
+		// it found, so closing the file does not unmap it while pixels are copied.
+		std::shared_ptr<const Contents> contents;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,95 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#include "BitmapCache.h"
+
+namespace jrc
+{
+	BitmapCache::BitmapCache()
+	{
+		budget = 0;
+		stats = {};
+	}
+
+	void BitmapCache::set_budget(size_t bytes)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		budget = bytes;
+		evict();
+	}
+
+	BitmapCache::Pixels BitmapCache::find(size_t id)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto iter = index.find(id);
+
+		if (iter == index.end())
+		{
+			stats.misses++;
+			return nullptr;
+		}
+
+		stats.hits++;
+		entries.splice(entries.begin(), entries, iter->second);
+
+		return iter->second->second;
+	}
+
+	void BitmapCache::insert(size_t id, Pixels pixels)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (!pixels || pixels->size() > budget || index.count(id))
+			return;
+
+		entries.emplace_front(id, pixels);
+		index.emplace(id, entries.begin());
+		stats.bytes += pixels->size();
+
+		evict();
+	}
+
+	bool BitmapCache::accepts(size_t bytes) const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		return bytes > 0 && bytes <= budget;
+	}
+
+	BitmapCache::Stats BitmapCache::get_stats() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		return stats;
+	}
+
+	void BitmapCache::evict()
+	{
+		while (stats.bytes > budget && !entries.empty())
+		{
+			const auto& last = entries.back();
+
+			stats.bytes -= last.second->size();
+			stats.evictions++;
+
+			index.erase(last.first);
+			entries.pop_back();
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace jrc
+{
+	// A bounded cache of decompressed bitmaps, keyed by bitmap id.
+	// Keeps recently used pixels in memory so that re-adding a bitmap
+	// to the atlas after it was cleared does not need another decode.
+	// Can be used from multiple threads.
+	class BitmapCache
+	{
+	public:
+		using Pixels = std::shared_ptr<const std::vector<uint8_t>>;
+
+		struct Stats
+		{
+			size_t hits;
+			size_t misses;
+			size_t evictions;
+			size_t bytes;
+		};
+
+		BitmapCache();
+
+		// Set the maximum number of bytes kept. Zero disables the cache.
+		void set_budget(size_t bytes);
+
+		// Return the pixels of a bitmap, or null if they are not cached.
+		Pixels find(size_t id);
+		// Store the pixels of a bitmap, evicting the least recently used entries if needed.
+		void insert(size_t id, Pixels pixels);
+		// Whether pixels of this many bytes would be kept by insert.
+		bool accepts(size_t bytes) const;
+
+		// Return the counters since the cache was created.
+		Stats get_stats() const;
+
+	private:
+		void evict();
+
+		using Entries = std::list<std::pair<size_t, Pixels>>;
+
+		Entries entries;
+		std::unordered_map<size_t, Entries::iterator> index;
+		size_t budget;
+		Stats stats;
+
+		mutable std::mutex mutex;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,549 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#include "DrawStream.h"
+#include "HeadlessBackend.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace jrc
+{
+	namespace
+	{
+		const char MAGIC[4] = { 'J', 'R', 'C', 'D' };
+		const uint32_t VERSION = 3;
+		// The longest block of bytes accepted, the pixels of a whole 8192x8192 atlas page.
+		const size_t MAXLENGTH = 8192 * 8192 * 4;
+
+		enum Command : uint8_t
+		{
+			INIT,
+			REINIT,
+			ADDPAGE,
+			UPLOAD,
+			UPLOADGLYPH,
+			STOREBATCH,
+			RELEASEBATCH,
+			BEGIN,
+			DRAWQUADS,
+			DRAWBATCH,
+			END,
+			DRAWWRAPPED
+		};
+	}
+
+	DrawStreamRecorder::DrawStreamRecorder(std::unique_ptr<RenderBackend> b, const std::string& filename, size_t mf) : backend(std::move(b)), file(filename, std::ios::binary), maxframes(mf)
+	{
+		frames = 0;
+		recording = file.is_open();
+
+		writeraw(MAGIC, sizeof(MAGIC));
+		write(VERSION);
+	}
+
+	Error DrawStreamRecorder::init(int16_t atlaswidth, int16_t atlasheight)
+	{
+		write(INIT);
+		write(atlaswidth);
+		write(atlasheight);
+
+		return backend->init(atlaswidth, atlasheight);
+	}
+
+	void DrawStreamRecorder::reinit(int16_t screenwidth, int16_t screenheight, int16_t fontregion)
+	{
+		write(REINIT);
+		write(screenwidth);
+		write(screenheight);
+		write(fontregion);
+
+		backend->reinit(screenwidth, screenheight, fontregion);
+	}
+
+	void DrawStreamRecorder::close()
+	{
+		stop();
+
+		backend->close();
+	}
+
+	void DrawStreamRecorder::addpage()
+	{
+		write(ADDPAGE);
+
+		backend->addpage();
+	}
+
+	void DrawStreamRecorder::upload(uint8_t page, int16_t x, int16_t y, int16_t width, int16_t height, const void* pixels)
+	{
+		write(UPLOAD);
+		write(page);
+		write(x);
+		write(y);
+		write(width);
+		write(height);
+		writebytes(pixels, pixels ? static_cast<size_t>(width) * height * 4 : 0);
+
+		backend->upload(page, x, y, width, height, pixels);
+	}
+
+	void DrawStreamRecorder::uploadglyph(uint8_t page, int16_t x, int16_t y, int16_t width, int16_t height, int32_t pitch, const void* pixels)
+	{
+		write(UPLOADGLYPH);
+		write(page);
+		write(x);
+		write(y);
+		write(width);
+		write(height);
+
+		// Rows are written without their padding, so they are read back with a pitch of the width.
+		auto source = static_cast<const uint8_t*>(pixels);
+		write(static_cast<uint32_t>(pixels ? width * height : 0));
+
+		for (int16_t row = 0; pixels && row < height; row++)
+			writeraw(source + row * pitch, width);
+
+		backend->uploadglyph(page, x, y, width, height, pitch, pixels);
+	}
+
+	void DrawStreamRecorder::storebatch(size_t id, const Quad* quads, size_t count)
+	{
+		write(STOREBATCH);
+		write(static_cast<uint64_t>(id));
+		writebytes(quads, count * sizeof(Quad));
+
+		backend->storebatch(id, quads, count);
+	}
+
+	void DrawStreamRecorder::releasebatch(size_t id)
+	{
+		write(RELEASEBATCH);
+		write(static_cast<uint64_t>(id));
+
+		backend->releasebatch(id);
+	}
+
+	void DrawStreamRecorder::begin(const Quad* quads, size_t count, size_t maxquads)
+	{
+		write(BEGIN);
+		write(static_cast<uint32_t>(maxquads));
+		writequads(quads, count);
+
+		backend->begin(quads, count, maxquads);
+	}
+
+	void DrawStreamRecorder::drawquads(size_t first, size_t last, uint8_t page)
+	{
+		write(DRAWQUADS);
+		write(static_cast<uint32_t>(first));
+		write(static_cast<uint32_t>(last));
+		write(page);
+
+		backend->drawquads(first, last, page);
+	}
+
+	void DrawStreamRecorder::drawwrapped(size_t first, size_t last, const Quad::Offset& region, Point<int16_t> period)
+	{
+		write(DRAWWRAPPED);
+		write(static_cast<uint32_t>(first));
+		write(static_cast<uint32_t>(last));
+		write(region.page);
+		write(region.l);
+		write(region.r);
+		write(region.t);
+		write(region.b);
+		write(period.x());
+		write(period.y());
+
+		backend->drawwrapped(first, last, region, period);
+	}
+
+	void DrawStreamRecorder::drawbatch(size_t id, size_t first, size_t last, uint8_t page, Point<int16_t> offset)
+	{
+		write(DRAWBATCH);
+		write(static_cast<uint64_t>(id));
+		write(static_cast<uint32_t>(first));
+		write(static_cast<uint32_t>(last));
+		write(page);
+		write(offset.x());
+		write(offset.y());
+
+		backend->drawbatch(id, first, last, page, offset);
+	}
+
+	void DrawStreamRecorder::end()
+	{
+		write(END);
+
+		// The stream ends after a complete frame, so it can be played up to there.
+		if (recording && ++frames == maxframes)
+			stop();
+
+		backend->end();
+	}
+
+	void DrawStreamRecorder::writeraw(const void* data, size_t length)
+	{
+		if (!recording)
+			return;
+
+		file.write(static_cast<const char*>(data), length);
+
+		if (!file)
+			stop();
+	}
+
+	void DrawStreamRecorder::writebytes(const void* data, size_t length)
+	{
+		write(static_cast<uint32_t>(length));
+
+		if (length > 0)
+			writeraw(data, length);
+	}
+
+	void DrawStreamRecorder::writequads(const Quad* quads, size_t count)
+	{
+		write(static_cast<uint32_t>(count));
+
+		auto unchanged = [&](size_t i) {
+			return i < previous.size() && std::memcmp(&quads[i], &previous[i], sizeof(Quad)) == 0;
+		};
+
+		size_t i = 0;
+		while (i < count)
+		{
+			size_t same = i;
+			while (same < count && unchanged(same))
+				same++;
+
+			size_t changed = same;
+			while (changed < count && !unchanged(changed))
+				changed++;
+
+			write(static_cast<uint32_t>(same - i));
+			write(static_cast<uint32_t>(changed - same));
+			writeraw(quads + same, (changed - same) * sizeof(Quad));
+
+			i = changed;
+		}
+
+		previous.assign(quads, quads + count);
+	}
+
+	void DrawStreamRecorder::stop()
+	{
+		recording = false;
+		previous.clear();
+
+		if (file.is_open())
+			file.close();
+	}
+
+	DrawStreamPlayer::DrawStreamPlayer(const std::string& filename) : file(filename, std::ios::binary)
+	{
+		stats = {};
+		atlaswidth = 0;
+		atlasheight = 0;
+		pages = 0;
+
+		char magic[4] = {};
+		file.read(magic, sizeof(magic));
+		uint32_t version = read<uint32_t>();
+
+		valid = file.good() && std::equal(magic, magic + 4, MAGIC) && version == VERSION;
+	}
+
+	bool DrawStreamPlayer::is_open() const
+	{
+		return valid;
+	}
+
+	bool DrawStreamPlayer::nextframe(RenderBackend& backend)
+	{
+		using clock = std::chrono::steady_clock;
+
+		while (valid)
+		{
+			Command command = read<Command>();
+
+			if (!file)
+				break;
+
+			auto start = clock::now();
+
+			switch (command)
+			{
+			case INIT:
+			{
+				int16_t width = read<int16_t>();
+				int16_t height = read<int16_t>();
+
+				if (!check(width > 0 && height > 0))
+					return false;
+
+				atlaswidth = width;
+				atlasheight = height;
+
+				// Setting up the backend is not part of the workload of a frame.
+				backend.init(width, height);
+				continue;
+			}
+			case REINIT:
+			{
+				int16_t width = read<int16_t>();
+				int16_t height = read<int16_t>();
+				int16_t fontregion = read<int16_t>();
+
+				if (!check(width >= 0 && height >= 0))
+					return false;
+
+				backend.reinit(width, height, fontregion);
+				continue;
+			}
+			case ADDPAGE:
+				pages++;
+				backend.addpage();
+				continue;
+			case UPLOAD:
+			case UPLOADGLYPH:
+			{
+				uint8_t page = read<uint8_t>();
+				int16_t x = read<int16_t>();
+				int16_t y = read<int16_t>();
+				int16_t width = read<int16_t>();
+				int16_t height = read<int16_t>();
+
+				bool inside = page < pages && x >= 0 && y >= 0 && width >= 0 && height >= 0
+					&& x + width <= atlaswidth && y + height <= atlasheight;
+
+				if (!check(inside))
+					return false;
+
+				size_t texels = static_cast<size_t>(width) * height;
+				size_t expected = command == UPLOAD ? texels * 4 : texels;
+				size_t length = readbytes(expected);
+
+				// Uploads without pixels only reserve the space.
+				if (!check(length == 0 || length == expected))
+					return false;
+
+				const void* pixels = length > 0 ? buffer.data() : nullptr;
+
+				stats.uploads++;
+				stats.upload_bytes += length;
+
+				start = clock::now();
+
+				if (command == UPLOAD)
+					backend.upload(page, x, y, width, height, pixels);
+				else
+					backend.uploadglyph(page, x, y, width, height, width, pixels);
+
+				break;
+			}
+			case STOREBATCH:
+			{
+				size_t id = static_cast<size_t>(read<uint64_t>());
+				size_t length = readbytes(MAXLENGTH);
+
+				if (!check(length % sizeof(Quad) == 0))
+					return false;
+
+				start = clock::now();
+				backend.storebatch(id, reinterpret_cast<const Quad*>(buffer.data()), length / sizeof(Quad));
+				break;
+			}
+			case RELEASEBATCH:
+			{
+				size_t id = static_cast<size_t>(read<uint64_t>());
+
+				if (!check(true))
+					return false;
+
+				backend.releasebatch(id);
+				break;
+			}
+			case BEGIN:
+			{
+				size_t maxquads = read<uint32_t>();
+				size_t count = readquads();
+
+				if (!check(true))
+					return false;
+
+				stats.quads += count;
+
+				start = clock::now();
+				backend.begin(reinterpret_cast<const Quad*>(frame.data()), count, maxquads);
+				break;
+			}
+			case DRAWQUADS:
+			{
+				size_t first = read<uint32_t>();
+				size_t last = read<uint32_t>();
+				uint8_t page = read<uint8_t>();
+
+				if (!check(page < pages))
+					return false;
+
+				start = clock::now();
+				backend.drawquads(first, last, page);
+				break;
+			}
+			case DRAWWRAPPED:
+			{
+				size_t first = read<uint32_t>();
+				size_t last = read<uint32_t>();
+
+				Quad::Offset region;
+				region.page = read<uint8_t>();
+				region.l = read<int16_t>();
+				region.r = read<int16_t>();
+				region.t = read<int16_t>();
+				region.b = read<int16_t>();
+
+				int16_t x = read<int16_t>();
+				int16_t y = read<int16_t>();
+
+				if (!check(region.page < pages && x > 0 && y > 0))
+					return false;
+
+				start = clock::now();
+				backend.drawwrapped(first, last, region, { x, y });
+				break;
+			}
+			case DRAWBATCH:
+			{
+				size_t id = static_cast<size_t>(read<uint64_t>());
+				size_t first = read<uint32_t>();
+				size_t last = read<uint32_t>();
+				uint8_t page = read<uint8_t>();
+				int16_t x = read<int16_t>();
+				int16_t y = read<int16_t>();
+
+				if (!check(page < pages))
+					return false;
+
+				start = clock::now();
+				backend.drawbatch(id, first, last, page, { x, y });
+				break;
+			}
+			case END:
+				backend.end();
+
+				stats.frames++;
+				stats.millis += std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+				return true;
+			default:
+				valid = false;
+				return false;
+			}
+
+			stats.millis += std::chrono::duration<double, std::milli>(clock::now() - start).count();
+		}
+
+		return false;
+	}
+
+	const DrawStreamPlayer::Stats& DrawStreamPlayer::get_stats() const
+	{
+		return stats;
+	}
+
+	bool DrawStreamPlayer::check(bool condition)
+	{
+		if (!condition || !file)
+			valid = false;
+
+		return valid;
+	}
+
+	size_t DrawStreamPlayer::readbytes(size_t maxlength)
+	{
+		size_t length = read<uint32_t>();
+
+		if (!check(length <= maxlength))
+			return 0;
+
+		buffer.resize(length);
+
+		if (length > 0)
+			file.read(reinterpret_cast<char*>(buffer.data()), length);
+
+		return length;
+	}
+
+	size_t DrawStreamPlayer::readquads()
+	{
+		size_t count = read<uint32_t>();
+
+		if (!check(count <= MAXLENGTH / sizeof(Quad)))
+			return 0;
+
+		// Quads outside of the changed runs are kept from the previous frame.
+		frame.resize(count * sizeof(Quad));
+
+		size_t i = 0;
+		while (i < count && file)
+		{
+			size_t same = read<uint32_t>();
+			size_t changed = read<uint32_t>();
+
+			if (same + changed == 0 || same + changed > count - i)
+				break;
+
+			i += same;
+			file.read(reinterpret_cast<char*>(frame.data() + i * sizeof(Quad)), changed * sizeof(Quad));
+			i += changed;
+		}
+
+		check(i == count);
+
+		return count;
+	}
+
+	void DrawStreamPlayer::replay(const std::string& filename, const std::string& pngfile)
+	{
+		DrawStreamPlayer player(filename);
+
+		if (!player.is_open())
+		{
+			std::cout << "Could not open the draw stream " << filename << std::endl;
+			return;
+		}
+
+		HeadlessBackend backend(!pngfile.empty());
+
+		while (player.nextframe(backend));
+
+		const Stats& stats = player.get_stats();
+		size_t frames = std::max<size_t>(stats.frames, 1);
+
+		std::cout << stats.frames << " frames: " << stats.millis / frames << " ms per frame in the backend, "
+			<< stats.quads / frames << " streamed quads per frame, "
+			<< stats.uploads << " uploads of " << stats.upload_bytes / 1024 << " KB" << std::endl;
+
+		if (!pngfile.empty() && !backend.writepng(pngfile))
+			std::cout << "Could not write " << pngfile << std::endl;
+
+		backend.close();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,135 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "RenderBackend.h"
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace jrc
+{
+	// Writes every call to a render backend into a file before passing it on, so that a captured
+	// session can be drawn again at the same workload without a server or game input.
+	// The file holds the atlas uploads with their pixels and the quads of every frame that changed since the one before.
+	// Recording stops after the given number of frames, or when the file cannot be written, and the calls are only passed on.
+	class DrawStreamRecorder : public RenderBackend
+	{
+	public:
+		// Record up to maxframes frames, or until the backend is closed with a maximum of 0.
+		DrawStreamRecorder(std::unique_ptr<RenderBackend> backend, const std::string& filename, size_t maxframes);
+
+		Error init(int16_t atlaswidth, int16_t atlasheight) override;
+		void reinit(int16_t screenwidth, int16_t screenheight, int16_t fontregion) override;
+		void close() override;
+
+		void addpage() override;
+		void upload(uint8_t page, int16_t x, int16_t y, int16_t width, int16_t height, const void* pixels) override;
+		void uploadglyph(uint8_t page, int16_t x, int16_t y, int16_t width, int16_t height, int32_t pitch, const void* pixels) override;
+
+		void storebatch(size_t id, const Quad* quads, size_t count) override;
+		void releasebatch(size_t id) override;
+
+		void begin(const Quad* quads, size_t count, size_t maxquads) override;
+		void drawquads(size_t first, size_t last, uint8_t page) override;
+		void drawwrapped(size_t first, size_t last, const Quad::Offset& region, Point<int16_t> period) override;
+		void drawbatch(size_t id, size_t first, size_t last, uint8_t page, Point<int16_t> offset) override;
+		void end() override;
+
+	private:
+		template <typename T>
+		void write(T value)
+		{
+			writeraw(&value, sizeof(T));
+		}
+
+		// Write bytes as they are, and stop recording if the file fails.
+		void writeraw(const void* data, size_t length);
+		// Write a length followed by the bytes.
+		void writebytes(const void* data, size_t length);
+		// Write the quads of a frame as runs of those that are unchanged since the previous frame and those that changed.
+		void writequads(const Quad* quads, size_t count);
+		void stop();
+
+		std::unique_ptr<RenderBackend> backend;
+		std::ofstream file;
+		std::vector<Quad> previous;
+		size_t maxframes;
+		size_t frames;
+		bool recording;
+	};
+
+	// Reads a recorded draw stream and issues its calls to a backend, one frame at a time.
+	class DrawStreamPlayer
+	{
+	public:
+		// Open a recorded file. Check is_open before playing it.
+		DrawStreamPlayer(const std::string& filename);
+
+		// Whether the file exists and has the right format.
+		bool is_open() const;
+		// Issue the calls up to the end of the next frame. Returns false when there are no more frames.
+		bool nextframe(RenderBackend& backend);
+
+		// Counters of the calls issued so far.
+		struct Stats
+		{
+			size_t frames;
+			size_t quads;
+			size_t uploads;
+			size_t upload_bytes;
+			// Time spent in the backend, without reading the file.
+			double millis;
+		};
+
+		const Stats& get_stats() const;
+
+		// Play a recorded file into the headless backend and print the time taken per frame.
+		// With a png filename the frames are rasterized and the last one is written to it.
+		static void replay(const std::string& filename, const std::string& pngfile);
+
+	private:
+		template <typename T>
+		T read()
+		{
+			T value = {};
+			file.read(reinterpret_cast<char*>(&value), sizeof(T));
+
+			return value;
+		}
+
+		// Mark the stream as invalid if the condition is false or the file ended. Returns whether it is still valid.
+		bool check(bool condition);
+		// Read a block of at most maxlength bytes into the buffer and return its length.
+		size_t readbytes(size_t maxlength);
+		// Apply the changed runs of quads to the previous frame and return the number of quads.
+		size_t readquads();
+
+		std::ifstream file;
+		std::vector<uint8_t> buffer;
+		std::vector<uint8_t> frame;
+		Stats stats;
+		// The atlas as set up by the stream, to check its uploads and draws against.
+		int16_t atlaswidth;
+		int16_t atlasheight;
+		size_t pages;
+		bool valid;
+	};
+}
\ No newline at end of file
@@ -51,6 +51,17 @@ namespace jrc
 		}
 	}
 
+	bool EffectLayer::empty() const
+	{
+		for (auto& effectlist : effects)
+		{
+			if (!effectlist.second.empty())
+				return false;
+		}
+
+		return true;
+	}
+
 	void EffectLayer::add(const Animation& animation, const DrawArgument& args, int8_t z, float speed)
 	{
 		effects[z].emplace_back(animation, args, speed);
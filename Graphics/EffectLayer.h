@@ -32,6 +32,7 @@ namespace jrc
 		void drawbelow(Point<int16_t> position, float alpha) const;
 		void drawabove(Point<int16_t> position, float alpha) const;
 		void update();
+		bool empty() const;
 		void add(const Animation& effect, const DrawArgument& args, int8_t z, float speed);
 		void add(const Animation& effect, const DrawArgument& args, int8_t z);
 		void add(const Animation& effect, const DrawArgument& args);
@@ -0,0 +1,371 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#include "GlyphCache.h"
+
+#include "../Util/Misc.h"
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+namespace jrc
+{
+	GlyphCache::GlyphCache()
+	{
+		library = nullptr;
+
+		for (auto& face : faces)
+			face = nullptr;
+
+		for (auto& height : heights)
+			height = 0;
+
+		backend = nullptr;
+		width = 0;
+		top = 0;
+		rowheight = 0;
+		frame = 1;
+		stats = {};
+	}
+
+	GlyphCache::~GlyphCache() {}
+
+	bool GlyphCache::init()
+	{
+		return FT_Init_FreeType(&library) == 0;
+	}
+
+	void GlyphCache::close()
+	{
+		for (auto& face : faces)
+		{
+			if (face)
+				FT_Done_Face(face);
+
+			face = nullptr;
+		}
+
+		if (library)
+			FT_Done_FreeType(library);
+
+		library = nullptr;
+
+		glyphs.clear();
+		rows.clear();
+	}
+
+	bool GlyphCache::addfont(const char* path, Text::Font font, FT_UInt pixelw, FT_UInt pixelh)
+	{
+		FT_Face face;
+
+		if (FT_New_Face(library, path, 0, &face))
+			return false;
+
+		if (FT_Set_Pixel_Sizes(face, pixelw, pixelh))
+		{
+			FT_Done_Face(face);
+			return false;
+		}
+
+		if (faces[font])
+			FT_Done_Face(faces[font]);
+
+		faces[font] = face;
+
+		// Line spacing stays based on the printable ascii range, so that layouts do not change with the text.
+		int16_t height = 0;
+
+		for (char32_t c = 32; c < 128; c++)
+			height = std::max(height, get(font, c).height);
+
+		heights[font] = height;
+
+		return true;
+	}
+
+	void GlyphCache::setregion(RenderBackend* b, int16_t w, int16_t t, int16_t h)
+	{
+		backend = b;
+		width = w;
+		top = t;
+
+		// Rows are as high as the tallest line of any font, so that every glyph fits into every row.
+		rowheight = 1;
+
+		for (auto& face : faces)
+		{
+			if (!face)
+				continue;
+
+			const FT_Size_Metrics& metrics = face->size->metrics;
+			FT_Pos extent = std::max(metrics.height, metrics.ascender - metrics.descender);
+
+			rowheight = std::max(rowheight, static_cast<int16_t>((extent >> 6) + 2));
+		}
+
+		rows.clear();
+
+		for (int16_t y = top; y + rowheight <= top + h; y += rowheight)
+			rows.push_back({ y, 0, 0, {} });
+
+		for (auto& iter : glyphs)
+			iter.second.row = NOROW;
+	}
+
+	int16_t GlyphCache::get_bottom() const
+	{
+		return static_cast<int16_t>(top + rows.size() * rowheight);
+	}
+
+	int16_t GlyphCache::get_height(Text::Font font) const
+	{
+		return heights[font];
+	}
+
+	const GlyphCache::Glyph& GlyphCache::get(Text::Font font, char32_t codepoint)
+	{
+		uint64_t key = makekey(font, codepoint);
+		auto iter = glyphs.find(key);
+
+		if (iter != glyphs.end())
+			return iter->second;
+
+		Glyph glyph = {};
+		glyph.row = NOROW;
+
+		FT_Face face = faces[font];
+
+		if (face && !FT_Load_Char(face, codepoint, FT_LOAD_RENDER))
+		{
+			FT_GlyphSlot slot = face->glyph;
+
+			glyph.advance = static_cast<int16_t>(slot->advance.x >> 6);
+			glyph.left = static_cast<int16_t>(slot->bitmap_left);
+			glyph.top = static_cast<int16_t>(slot->bitmap_top);
+			glyph.width = static_cast<int16_t>(slot->bitmap.width);
+			glyph.height = static_cast<int16_t>(slot->bitmap.rows);
+		}
+
+		return glyphs.emplace(key, glyph).first->second;
+	}
+
+	const GlyphCache::Glyph* GlyphCache::place(Text::Font font, char32_t codepoint)
+	{
+		Glyph& glyph = const_cast<Glyph&>(get(font, codepoint));
+
+		// Whitespace has nothing to draw.
+		if (glyph.width <= 0 || glyph.height <= 0)
+			return &glyph;
+
+		if (glyph.row != NOROW)
+		{
+			rows[glyph.row].lastuse = frame;
+			stats.hits++;
+
+			return &glyph;
+		}
+
+		stats.misses++;
+
+		uint16_t rid = glyph.height <= rowheight ? findrow(glyph.width) : NOROW;
+
+		if (rid == NOROW)
+		{
+			stats.failures++;
+			return nullptr;
+		}
+
+		// Only the metrics are kept, so the bitmap is rendered again.
+		FT_Face face = faces[font];
+
+		if (FT_Load_Char(face, codepoint, FT_LOAD_RENDER))
+		{
+			stats.failures++;
+			return nullptr;
+		}
+
+		Row& row = rows[rid];
+
+		if (backend)
+		{
+			const FT_Bitmap& bitmap = face->glyph->bitmap;
+
+			backend->uploadglyph(0, row.x, row.y, glyph.width, glyph.height, bitmap.pitch, bitmap.buffer);
+		}
+
+		glyph.x = row.x;
+		glyph.y = row.y;
+		glyph.row = rid;
+
+		row.x += glyph.width;
+		row.lastuse = frame;
+		row.keys.push_back(makekey(font, codepoint));
+
+		return &glyph;
+	}
+
+	uint16_t GlyphCache::findrow(int16_t w)
+	{
+		if (w > width)
+			return NOROW;
+
+		for (uint16_t i = 0; i < rows.size(); i++)
+			if (rows[i].x + w <= width)
+				return i;
+
+		uint16_t lru = NOROW;
+
+		for (uint16_t i = 0; i < rows.size(); i++)
+		{
+			if (rows[i].lastuse == frame)
+				continue;
+
+			if (lru == NOROW || rows[i].lastuse < rows[lru].lastuse)
+				lru = i;
+		}
+
+		if (lru == NOROW)
+			return NOROW;
+
+		Row& row = rows[lru];
+
+		for (auto key : row.keys)
+		{
+			auto iter = glyphs.find(key);
+
+			if (iter != glyphs.end())
+				iter->second.row = NOROW;
+		}
+
+		row.keys.clear();
+		row.x = 0;
+
+		stats.evictions++;
+
+		return lru;
+	}
+
+	void GlyphCache::nextframe()
+	{
+		frame++;
+	}
+
+	void GlyphCache::clear()
+	{
+		for (auto& row : rows)
+		{
+			row.x = 0;
+			row.keys.clear();
+		}
+
+		for (auto& iter : glyphs)
+			iter.second.row = NOROW;
+	}
+
+	const GlyphCache::Stats& GlyphCache::get_stats() const
+	{
+		return stats;
+	}
+
+	uint64_t GlyphCache::makekey(Text::Font font, char32_t codepoint)
+	{
+		return (static_cast<uint64_t>(font) << 32) | codepoint;
+	}
+
+	void GlyphCache::benchmark(const std::string& path)
+	{
+		const size_t FRAMES = 6000;
+		const size_t MESSAGEFRAMES = 5;
+		const size_t LINES = 30;
+
+		const char* words[] = { "lf", "party", "hp", "pots", "buying", "selling", "ms", "gg", "pls", "ty", "meso", "scroll", "@", "100%", "lol" };
+
+		GlyphCache cache;
+
+		if (!cache.init() || !cache.addfont(path.c_str(), Text::A12M, 0, 12))
+		{
+			std::cout << "Could not load the font " << path << std::endl;
+			cache.close();
+			return;
+		}
+
+		// The small region forces rows to be evicted while the channel keeps using new characters.
+		for (auto region : { Point<int16_t>(8192, 256), Point<int16_t>(2048, 64), Point<int16_t>(1024, 64) })
+		{
+			cache.setregion(nullptr, region.x(), 1, region.y());
+			cache.stats = {};
+
+			std::mt19937 random(1);
+			std::geometric_distribution<int> syllable(0.004);
+			std::uniform_int_distribution<size_t> wordcount(2, 10);
+			std::uniform_int_distribution<size_t> ascii(0, sizeof(words) / sizeof(words[0]) - 1);
+			std::bernoulli_distribution hangul(0.6);
+
+			std::vector<std::string> log;
+
+			for (size_t f = 0; f < FRAMES; f++)
+			{
+				if (f % MESSAGEFRAMES == 0)
+				{
+					std::string message;
+
+					for (size_t w = wordcount(random); w > 0; w--)
+					{
+						if (hangul(random))
+						{
+							// Common syllables are used far more often than rare ones.
+							for (size_t s = 1 + random() % 3; s > 0; s--)
+								utf8::append(message, 0xAC00 + std::min(syllable(random), 11171));
+						}
+						else
+						{
+							message += words[ascii(random)];
+						}
+
+						message += ' ';
+					}
+
+					log.push_back(message);
+
+					if (log.size() > LINES)
+						log.erase(log.begin());
+				}
+
+				for (auto& line : log)
+				{
+					size_t pos = 0;
+
+					while (pos < line.size())
+						cache.place(Text::A12M, utf8::decode(line.c_str(), line.size(), pos));
+				}
+
+				cache.nextframe();
+			}
+
+			const Stats& stats = cache.stats;
+			size_t lookups = stats.hits + stats.misses;
+
+			std::cout << region.x() << "x" << region.y() << " region: " << lookups << " lookups, "
+				<< 100.0 * stats.hits / std::max<size_t>(lookups, 1) << "% hits, "
+				<< stats.misses << " rasterized, " << stats.evictions << " rows evicted, "
+				<< stats.failures << " failed" << std::endl;
+		}
+
+		cache.close();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "RenderBackend.h"
+#include "Text.h"
+
+#include "ft2build.h"
+#include FT_FREETYPE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace jrc
+{
+	// Rasterizes the glyphs of each font with FreeType when they are first used, and keeps them
+	// in rows of the font region of the atlas. When the region is full, the row which was drawn
+	// from least recently is cleared. Rows used by the current frame are never cleared.
+	class GlyphCache
+	{
+	public:
+		struct Glyph
+		{
+			int16_t advance;
+			int16_t left;
+			int16_t top;
+			int16_t width;
+			int16_t height;
+			int16_t x;
+			int16_t y;
+			uint16_t row;
+		};
+
+		struct Stats
+		{
+			size_t hits;
+			size_t misses;
+			size_t evictions;
+			size_t failures;
+		};
+
+		// The row of glyphs which are not in the atlas.
+		static const uint16_t NOROW = 0xFFFF;
+
+		GlyphCache();
+		~GlyphCache();
+
+		// Initialise FreeType. Returns false if it fails.
+		bool init();
+		// Release all faces and FreeType.
+		void close();
+
+		// Load a font file with the given pixel size. Returns false if it can not be loaded.
+		bool addfont(const char* path, Text::Font font, FT_UInt width, FT_UInt height);
+		// Use the rows from top to top + height of the first atlas page for glyphs, once all fonts are added.
+		// Without a backend the glyphs are only rasterized, which is enough for measuring the cache.
+		void setregion(RenderBackend* backend, int16_t width, int16_t top, int16_t height);
+		// Return the first row below the region.
+		int16_t get_bottom() const;
+		// Return the height of the tallest printable ascii glyph of a font.
+		int16_t get_height(Text::Font font) const;
+
+		// Return the metrics of the glyph for a code point. It may not be in the atlas.
+		const Glyph& get(Text::Font font, char32_t codepoint);
+		// Return the glyph for a code point after making sure that it is in the atlas.
+		// Returns null if there is no space which is not used by the current frame.
+		const Glyph* place(Text::Font font, char32_t codepoint);
+		// Start a new frame, so that rows used by the last one may be cleared.
+		void nextframe();
+		// Remove all glyphs from the atlas.
+		void clear();
+
+		// Return the counters of place.
+		const Stats& get_stats() const;
+
+		// Draw a simulated chat log in a busy channel with the font file and print the hit rate of the cache.
+		static void benchmark(const std::string& path);
+
+	private:
+		struct Row
+		{
+			int16_t y;
+			int16_t x;
+			uint64_t lastuse;
+			std::vector<uint64_t> keys;
+		};
+
+		static uint64_t makekey(Text::Font font, char32_t codepoint);
+		// Find space for a glyph, clearing the least recently used row if necessary.
+		uint16_t findrow(int16_t width);
+
+		FT_Library library;
+		FT_Face faces[Text::NUM_FONTS];
+		int16_t heights[Text::NUM_FONTS];
+
+		std::unordered_map<uint64_t, Glyph> glyphs;
+		std::vector<Row> rows;
+
+		RenderBackend* backend;
+		int16_t width;
+		int16_t top;
+		int16_t rowheight;
+		uint64_t frame;
+		Stats stats;
+	};
+}
\ No newline at end of file
@@ -16,17 +16,34 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
 //////////////////////////////////////////////////////////////////////////////
 #include "GraphicsGL.h"
+#include "DrawStream.h"
+#include "OpenGLBackend.h"
 
 #include "../Configuration.h"
 #include "../Console.h"
 
+#include "../Util/Misc.h"
+
 #include <algorithm>
+#include <chrono>
+#include <iostream>
 
 namespace jrc
 {
-	GraphicsGL::GraphicsGL()
+	GraphicsGL::GraphicsGL() : streamer(bitmapcache, bakedtextures)
 	{
 		locked = false;
+		streaming = false;
+		maxpages = 1;
+		currentpage = 0;
+		frame = 0;
+		atlasfull = false;
+		collecting = nullptr;
+		upload_budget_bytes = 0;
+		upload_budget_count = 0;
+		streamstats = {};
+		drawstats = {};
+		wrappedtiles = 0;
 
 		VWIDTH = Constants::Constants::get().get_viewwidth();
 		VHEIGHT = Constants::Constants::get().get_viewheight();
@@ -35,97 +52,29 @@ namespace jrc
 
 	Error GraphicsGL::init()
 	{
-		if (glewInit())
-			return Error::GLEW;
+		return init(std::make_unique<OpenGLBackend>());
+	}
+
+	Error GraphicsGL::init(std::unique_ptr<RenderBackend> renderbackend)
+	{
+		backend = std::move(renderbackend);
+
+		const std::string STREAM_FILE = Setting<DrawStreamFile>::get().load();
 
-		if (FT_Init_FreeType(&ftlibrary))
+		if (!STREAM_FILE.empty())
+			backend = std::make_unique<DrawStreamRecorder>(std::move(backend), STREAM_FILE, Setting<DrawStreamFrames>::get().load());
+
+		if (Error error = backend->init(ATLASW, ATLASH))
+			return error;
+
+		if (!glyphs.init())
 			return Error::FREETYPE;
 
-		GLint result = GL_FALSE;
-		GLuint vs = glCreateShader(GL_VERTEX_SHADER);
-
-		const char *vs_source =
-			"#version 120\n"
-			"attribute vec4 coord;"
-			"attribute vec4 color;"
-			"varying vec2 texpos;"
-			"varying vec4 colormod;"
-			"uniform vec2 screensize;"
-			"uniform int yoffset;"
-
-			"void main(void) {"
-			"	float x = -1.0 + coord.x * 2.0 / screensize.x;"
-			"	float y = 1.0 - (coord.y + yoffset) * 2.0 / screensize.y;"
-			"   gl_Position = vec4(x, y, 0.0, 1.0);"
-			"	texpos = coord.zw;"
-			"	colormod = color;"
-			"}";
-
-		glShaderSource(vs, 1, &vs_source, NULL);
-		glCompileShader(vs);
-		glGetShaderiv(vs, GL_COMPILE_STATUS, &result);
-
-		if (!result)
-			return Error::VERTEX_SHADER;
-
-		GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
-
-		const char *fs_source =
-			"#version 120\n"
-			"varying vec2 texpos;"
-			"varying vec4 colormod;"
-			"uniform sampler2D texture;"
-			"uniform vec2 atlassize;"
-			"uniform int fontregion;"
-
-			"void main(void) {"
-			"	if (texpos.y == 0) {"
-			"		gl_FragColor = colormod;"
-			"	} else if (texpos.y <= fontregion) {"
-			"		gl_FragColor = vec4(1, 1, 1, texture2D(texture, texpos / atlassize).r) * colormod;"
-			"	} else {"
-			"		gl_FragColor = texture2D(texture, texpos / atlassize) * colormod;"
-			"	}"
-			"}";
-
-		glShaderSource(fs, 1, &fs_source, NULL);
-		glCompileShader(fs);
-		glGetShaderiv(fs, GL_COMPILE_STATUS, &result);
-
-		if (!result)
-			return Error::FRAGMENT_SHADER;
-
-		program = glCreateProgram();
-
-		glAttachShader(program, vs);
-		glAttachShader(program, fs);
-		glLinkProgram(program);
-		glGetProgramiv(program, GL_LINK_STATUS, &result);
-
-		if (!result)
-			return Error::SHADER_PROGRAM;
-
-		attribute_coord = glGetAttribLocation(program, "coord");
-		attribute_color = glGetAttribLocation(program, "color");
-		uniform_texture = glGetUniformLocation(program, "texture");
-		uniform_atlassize = glGetUniformLocation(program, "atlassize");
-		uniform_screensize = glGetUniformLocation(program, "screensize");
-		uniform_yoffset = glGetUniformLocation(program, "yoffset");
-		uniform_fontregion = glGetUniformLocation(program, "fontregion");
-
-		if (attribute_coord == -1 || attribute_color == -1 || uniform_texture == -1 || uniform_atlassize == -1 || uniform_yoffset == -1 || uniform_screensize == -1)
-			return Error::SHADER_VARS;
-
-		glGenBuffers(1, &vbo);
-
-		glGenTextures(1, &atlas);
-		glBindTexture(GL_TEXTURE_2D, atlas);
-		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, ATLASW, ATLASH, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-
-		fontborder.set_y(1);
+		maxpages = std::max<uint8_t>(Setting<AtlasPages>::get().load(), 1);
+		packertype = AtlasPacker::by_name(Setting<AtlasPackerType>::get().load());
+
+		// The fonts are drawn from the first page.
+		addpage();
 
 		const std::string FONT_NORMAL = Setting<FontPathNormal>().get().load();
 		const std::string FONT_BOLD = Setting<FontPathBold>().get().load();
@@ -136,314 +85,609 @@ namespace jrc
 		const char* FONT_NORMAL_STR = FONT_NORMAL.c_str();
 		const char* FONT_BOLD_STR = FONT_BOLD.c_str();
 
-		addfont(FONT_NORMAL_STR, Text::A11M, 0, 11);
-		addfont(FONT_BOLD_STR, Text::A11B, 0, 11);
-		addfont(FONT_NORMAL_STR, Text::A12M, 0, 12);
-		addfont(FONT_BOLD_STR, Text::A12B, 0, 12);
-		addfont(FONT_NORMAL_STR, Text::A13M, 0, 13);
-		addfont(FONT_BOLD_STR, Text::A13B, 0, 13);
-		addfont(FONT_BOLD_STR, Text::A15B, 0, 15);
-		addfont(FONT_NORMAL_STR, Text::A18M, 0, 18);
+		glyphs.addfont(FONT_NORMAL_STR, Text::A11M, 0, 11);
+		glyphs.addfont(FONT_BOLD_STR, Text::A11B, 0, 11);
+		glyphs.addfont(FONT_NORMAL_STR, Text::A12M, 0, 12);
+		glyphs.addfont(FONT_BOLD_STR, Text::A12B, 0, 12);
+		glyphs.addfont(FONT_NORMAL_STR, Text::A13M, 0, 13);
+		glyphs.addfont(FONT_BOLD_STR, Text::A13B, 0, 13);
+		glyphs.addfont(FONT_BOLD_STR, Text::A15B, 0, 15);
+		glyphs.addfont(FONT_NORMAL_STR, Text::A18M, 0, 18);
 
-		fontymax += fontborder.y();
-
-		leftovers = QuadTree<size_t, Leftover>(
-			[](const Leftover& first, const Leftover& second)
-			{
-				bool wcomp = first.width() >= second.width();
-				bool hcomp = first.height() >= second.height();
-
-				if (wcomp && hcomp)
-					return QuadTree<size_t, Leftover>::RIGHT;
-				else if (wcomp)
-					return QuadTree<size_t, Leftover>::DOWN;
-				else if (hcomp)
-					return QuadTree<size_t, Leftover>::UP;
-				else
-					return QuadTree<size_t, Leftover>::LEFT;
-			}
-		);
+		for (size_t i = 0; i < Text::NUM_FONTS; i++)
+			fonts[i] = Font(glyphs.get_height(static_cast<Text::Font>(i)));
 
-		return Error::NONE;
-	}
+		// Glyphs are rasterized when first drawn, into rows starting below the untextured line.
+		glyphs.setregion(backend.get(), ATLASW, 1, GLYPHREGION);
+		fontymax = glyphs.get_bottom();
 
-	bool GraphicsGL::addfont(const char* name, Text::Font id, FT_UInt pixelw, FT_UInt pixelh)
-	{
-		FT_Face face;
+		clearinternal();
 
-		if (FT_New_Face(ftlibrary, name, 0, &face))
-			return false;
+		layouts.set_capacity(Setting<LayoutCacheSize>::get().load());
+		bitmapcache.set_budget(static_cast<size_t>(Setting<BitmapCacheMB>::get().load()) * 1024 * 1024);
 
-		if (FT_Set_Pixel_Sizes(face, pixelw, pixelh))
-			return false;
+		const std::string BAKED_FILE = Setting<BakedTextureFile>::get().load();
 
-		FT_GlyphSlot g = face->glyph;
+		if (!BAKED_FILE.empty())
+			bakedtextures.open(BAKED_FILE);
 
-		GLshort width = 0;
-		GLshort height = 0;
+		streaming = Setting<TextureStreaming>::get().load();
+		// Negative settings wrap around to huge unsigned values, so both budgets are clamped.
+		size_t upload_kb = Setting<TextureUploadKB>::get().load();
+		size_t upload_count = Setting<TextureUploadCount>::get().load();
+		upload_budget_bytes = std::min(std::max<size_t>(upload_kb, 1), size_t(MAXUPLOADKB)) * 1024;
+		upload_budget_count = std::min(std::max<size_t>(upload_count, 1), size_t(MAXUPLOADCOUNT));
 
-		for (uint8_t c = 32; c < 128; c++)
-		{
-			if (FT_Load_Char(face, c, FT_LOAD_RENDER))
-				continue;
+		if (streaming)
+			streamer.start(0);
 
-			GLshort w = static_cast<GLshort>(g->bitmap.width);
-			GLshort h = static_cast<GLshort>(g->bitmap.rows);
-
-			width += w;
+		return Error::NONE;
+	}
 
-			if (h > height)
-				height = h;
-		}
+	void GraphicsGL::reinit()
+	{
+		int32_t new_width = Constants::Constants::get().get_viewwidth();
+		int32_t new_height = Constants::Constants::get().get_viewheight();
 
-		if (fontborder.x() + width > ATLASW)
+		if (VWIDTH != new_width || VHEIGHT != new_height)
 		{
-			fontborder.set_x(0);
-			fontborder.set_y(fontymax);
-			fontymax = 0;
+			VWIDTH = new_width;
+			VHEIGHT = new_height;
+			SCREEN = Rectangle<int16_t>(0, VWIDTH, -Constants::VIEWYOFFSET, -Constants::VIEWYOFFSET + VHEIGHT);
 		}
 
-		GLshort x = fontborder.x();
-		GLshort y = fontborder.y();
+		backend->reinit(VWIDTH, VHEIGHT, fontymax);
 
-		fontborder.shift_x(width);
+		clearinternal();
+	}
 
-		if (height > fontymax)
-			fontymax = height;
+	void GraphicsGL::close()
+	{
+		streamer.stop();
+		streaming = false;
 
-		fonts[id] = Font(width, height);
+		if (backend)
+			backend->close();
 
-		GLshort ox = x;
-		GLshort oy = y;
+		batches.clear();
+		batchdraws.clear();
 
-		for (uint8_t c = 32; c < 128; c++)
+		bakedtextures.close();
+
+		glyphs.close();
+	}
+
+	void GraphicsGL::clearinternal()
+	{
+		// The height of the font region may have changed, so the packers are created again.
+		for (uint8_t i = 0; i < pages.size(); i++)
 		{
-			if (FT_Load_Char(face, c, FT_LOAD_RENDER))
-				continue;
+			pages[i].packer = AtlasPacker::create(packertype, ATLASW, ATLASH, fontymax);
+			evictpage(i);
+		}
 
-			GLshort ax = static_cast<GLshort>(g->advance.x >> 6);
-			GLshort ay = static_cast<GLshort>(g->advance.y >> 6);
-			GLshort l = static_cast<GLshort>(g->bitmap_left);
-			GLshort t = static_cast<GLshort>(g->bitmap_top);
-			GLshort w = static_cast<GLshort>(g->bitmap.width);
-			GLshort h = static_cast<GLshort>(g->bitmap.rows);
+		offsets.clear();
+		currentpage = 0;
+		atlasfull = false;
+	}
 
-			glTexSubImage2D(GL_TEXTURE_2D, 0, ox, oy, w, h, GL_RED, GL_UNSIGNED_BYTE, g->bitmap.buffer);
+	void GraphicsGL::clear()
+	{
+		for (uint8_t i = 0; i < pages.size(); i++)
+		{
+			const Page& page = pages[i];
 
-			Offset offset = Offset(ox, oy, w, h);
-			fonts[id].chars[c] = { ax, ay, w, h, l, t, offset };
+			size_t used = page.used + page.packer->get_wasted();
+			double usedpercent = static_cast<double>(used) / (ATLASW * (ATLASH - fontymax));
 
-			ox += w;
+			if (usedpercent > 0.8 && page.lastuse != frame)
+				evictpage(i);
 		}
-
-		return true;
 	}
 
-	void GraphicsGL::reinit()
+	uint8_t GraphicsGL::addpage()
 	{
-		int32_t new_width = Constants::Constants::get().get_viewwidth();
-		int32_t new_height = Constants::Constants::get().get_viewheight();
+		Page page;
 
-		if (VWIDTH != new_width || VHEIGHT != new_height)
-		{
-			VWIDTH = new_width;
-			VHEIGHT = new_height;
-			SCREEN = Rectangle<int16_t>(0, VWIDTH, -Constants::VIEWYOFFSET, -Constants::VIEWYOFFSET + VHEIGHT);
-		}
+		backend->addpage();
 
-		glUseProgram(program);
+		page.packer = AtlasPacker::create(packertype, ATLASW, ATLASH, fontymax);
 
-		glUniform1i(uniform_yoffset, Constants::VIEWYOFFSET);
-		glUniform1i(uniform_fontregion, fontymax);
-		glUniform2f(uniform_atlassize, ATLASW, ATLASH);
-		glUniform2f(uniform_screensize, VWIDTH, VHEIGHT);
+		page.evictions = 0;
+		page.lastuse = frame;
 
-		glBindBuffer(GL_ARRAY_BUFFER, vbo);
-		glVertexAttribPointer(attribute_coord, 4, GL_SHORT, GL_FALSE, sizeof(Quad::Vertex), 0);
-		glVertexAttribPointer(attribute_color, 4, GL_FLOAT, GL_FALSE, sizeof(Quad::Vertex), (const void*)8);
+		pages.push_back(std::move(page));
 
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		uint8_t id = static_cast<uint8_t>(pages.size() - 1);
+		evictpage(id);
+		pages[id].evictions = 0;
 
-		glBindTexture(GL_TEXTURE_2D, atlas);
-		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		return id;
+	}
 
-		clearinternal();
+	uint8_t GraphicsGL::leastrecent() const
+	{
+		uint8_t pid = 0;
+
+		for (uint8_t i = 1; i < pages.size(); i++)
+			if (pages[i].lastuse < pages[pid].lastuse)
+				pid = i;
+
+		return pid;
 	}
 
-	void GraphicsGL::clearinternal()
+	void GraphicsGL::evictpage(uint8_t id)
 	{
-		border = Point<GLshort>(0, fontymax);
-		yrange = Range<GLshort>();
+		Page& page = pages[id];
 
-		offsets.clear();
-		leftovers.clear();
-		rlid = 1;
-		wasted = 0;
+		for (auto bid : page.ids)
+			offsets.erase(bid);
+
+		page.ids.clear();
+		page.packer->clear();
+		page.used = 0;
+		// Batches built with offsets on this page have to be rebuilt.
+		page.evictions++;
 	}
 
-	void GraphicsGL::clear()
+	std::vector<GraphicsGL::PageStats> GraphicsGL::get_atlasstats() const
 	{
-		size_t used = ATLASW * border.y() + border.x() * yrange.second();
-		double usedpercent = static_cast<double>(used) / (ATLASW * ATLASH);
+		std::vector<PageStats> stats;
 
-		if (usedpercent > 80.0)
-			clearinternal();
+		size_t area = ATLASW * (ATLASH - fontymax);
+
+		for (auto& page : pages)
+		{
+			double occupancy = static_cast<double>(page.used) / area;
+			stats.push_back({ page.ids.size(), page.used, page.packer->get_wasted(), page.evictions, occupancy });
+		}
+
+		return stats;
 	}
 
 	void GraphicsGL::addbitmap(const nl::bitmap& bmp)
 	{
-		getoffset(bmp);
+		findoffset(bmp);
 	}
 
-	const GraphicsGL::Offset& GraphicsGL::getoffset(const nl::bitmap& bmp)
+	const GraphicsGL::Offset* GraphicsGL::getoffset(const nl::bitmap& bmp)
 	{
 		size_t id = bmp.id();
 		auto offiter = offsets.find(id);
 
 		if (offiter != offsets.end())
-			return offiter->second;
+			return &offiter->second;
 
-		GLshort x = 0;
-		GLshort y = 0;
-		GLshort w = bmp.width();
-		GLshort h = bmp.height();
+		if (auto pixels = bitmapcache.find(id))
+			return addoffset(id, bmp.width(), bmp.height(), pixels->data());
 
-		if (w <= 0 || h <= 0)
-			return nulloffset;
+		if (auto pixels = bakedtextures.load(bmp))
+		{
+			bitmapcache.insert(id, pixels);
 
-		auto value = Leftover(x, y, w, h);
+			return addoffset(id, bmp.width(), bmp.height(), pixels->data());
+		}
+
+		// Decode straight into the buffer the cache keeps, or into the shared buffer of nlnx if it would not be kept.
+		if (bitmapcache.accepts(bmp.length()))
+		{
+			auto pixels = std::make_shared<std::vector<uint8_t>>(bmp.length());
 
-		size_t lid = leftovers.findnode(
-			value,
-			[](const Leftover& val, const Leftover& leaf)
+			if (bmp.decode(pixels->data()))
 			{
-				return val.width() <= leaf.width() && val.height() <= leaf.height();
+				bitmapcache.insert(id, pixels);
+
+				return addoffset(id, bmp.width(), bmp.height(), pixels->data());
 			}
-		);
+		}
+
+		return addoffset(id, bmp.width(), bmp.height(), bmp.data());
+	}
+
+	const GraphicsGL::Offset* GraphicsGL::findoffset(const nl::bitmap& bmp)
+	{
+		if (!streaming)
+			return getoffset(bmp);
+
+		auto offiter = offsets.find(bmp.id());
+
+		if (offiter != offsets.end())
+			return &offiter->second;
+
+		if (bmp.width() == 0 || bmp.height() == 0)
+			return &nulloffset;
+
+		streamer.request(bmp);
 
-		if (lid > 0)
+		return nullptr;
+	}
+
+	void GraphicsGL::uploadstreamed()
+	{
+		streamstats.upload_bytes = 0;
+		streamstats.upload_count = 0;
+
+		TextureStreamer::Decoded decoded;
+
+		while (streamstats.upload_bytes < upload_budget_bytes && streamstats.upload_count < upload_budget_count)
 		{
-			const Leftover& leftover = leftovers[lid];
+			if (!streamer.poll(decoded))
+				break;
 
-			x = leftover.l;
-			y = leftover.t;
+			const nl::bitmap& bmp = decoded.bitmap;
 
-			GLshort wdelta = leftover.width() - w;
-			GLshort hdelta = leftover.height() - h;
+			if (offsets.count(bmp.id()))
+				continue;
 
-			leftovers.erase(lid);
+			// The atlas is full of bitmaps drawn this frame. The bitmap is requested again when it is next drawn.
+			if (!addoffset(bmp.id(), bmp.width(), bmp.height(), decoded.pixels->data()))
+				break;
+
+			streamstats.upload_bytes += decoded.pixels->size();
+			streamstats.upload_count++;
+		}
 
-			wasted -= w * h;
+		streamstats.queued = streamer.get_queued();
+	}
+
+	const GraphicsGL::StreamStats& GraphicsGL::get_streamstats() const
+	{
+		return streamstats;
+	}
+
+	const GraphicsGL::DrawStats& GraphicsGL::get_drawstats() const
+	{
+		return drawstats;
+	}
+
+	BitmapCache::Stats GraphicsGL::get_cachestats() const
+	{
+		return bitmapcache.get_stats();
+	}
+
+	LayoutCache::Stats GraphicsGL::get_layoutstats() const
+	{
+		return layouts.get_stats();
+	}
+
+	void GraphicsGL::benchmark(size_t count)
+	{
+		using clock = std::chrono::steady_clock;
+
+		const size_t FRAMES = 100;
+
+		Offset offset(64, 64, 32, 48, 0);
+		std::vector<Quad> frame;
+		frame.reserve(count);
+
+		for (float angle : { 0.0f, 0.5f })
+		{
+			auto start = clock::now();
 
-			if (wdelta >= MINLOSIZE && hdelta >= MINLOSIZE)
+			for (size_t i = 0; i < FRAMES; i++)
 			{
-				leftovers.add(rlid, Leftover(x + w, y + h, wdelta, hdelta));
-				rlid++;
+				frame.clear();
 
-				if (w >= MINLOSIZE)
+				for (size_t j = 0; j < count; j++)
 				{
-					leftovers.add(rlid, Leftover(x, y + h, w, hdelta));
-					rlid++;
-				}
+					GLshort x = static_cast<GLshort>(j % 800);
+					GLshort y = static_cast<GLshort>(j % 600);
+					Color color{ 1.0f, 1.0f, 1.0f, (j % 256) / 255.0f };
 
-				if (h >= MINLOSIZE)
-				{
-					leftovers.add(rlid, Leftover(x + w, y, wdelta, h));
-					rlid++;
+					frame.emplace_back(x, x + 32, y, y + 48, offset, color, angle);
 				}
 			}
-			else if (wdelta >= MINLOSIZE)
-			{
-				leftovers.add(rlid, Leftover(x + w, y, wdelta, h + hdelta));
-				rlid++;
-			}
-			else if (hdelta >= MINLOSIZE)
-			{
-				leftovers.add(rlid, Leftover(x, y + h, w + wdelta, hdelta));
-				rlid++;
-			}
+
+			double millis = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+			std::cout << (angle == 0.0f ? "unrotated" : "rotated") << ": "
+				<< (count * FRAMES) / millis << " quads per ms, "
+				<< count * sizeof(Quad) << " bytes per frame of " << count << " quads ("
+				<< sizeof(Quad::Vertex) << " bytes per vertex)" << std::endl;
 		}
-		else
-		{
-			if (border.x() + w > ATLASW)
-			{
-				border.set_x(0);
-				border.shift_y(yrange.second());
+	}
 
-				if (border.y() + h > ATLASH)
-					clearinternal();
-				else
-					yrange = Range<GLshort>();
-			}
+	const GraphicsGL::Offset* GraphicsGL::addoffset(size_t id, GLshort w, GLshort h, const void* pixels)
+	{
+		if (w <= 0 || h <= 0 || w > ATLASW || h > ATLASH - fontymax)
+			return &nulloffset;
 
-			x = border.x();
-			y = border.y();
+		GLshort x = 0;
+		GLshort y = 0;
 
-			border.shift_x(w);
+		// Try the page which was filled last, then the others, then a new page.
+		// If all pages are full, the least recently drawn one is evicted. Pages which were
+		// drawn from this frame are kept, because quads of this frame still point into them.
+		uint8_t pid = currentpage;
+		bool placed = pages[pid].packer->insert(w, h, x, y);
 
-			if (h > yrange.second())
-			{
-				if (x >= MINLOSIZE && h - yrange.second() >= MINLOSIZE)
-				{
-					leftovers.add(rlid, Leftover(0, yrange.first(), x, h - yrange.second()));
-					rlid++;
-				}
+		for (uint8_t i = 0; !placed && i < pages.size(); i++)
+		{
+			if (i == currentpage)
+				continue;
 
-				wasted += x * (h - yrange.second());
+			pid = i;
+			placed = pages[pid].packer->insert(w, h, x, y);
+		}
 
-				yrange = { y + h, h };
+		if (!placed)
+		{
+			if (pages.size() < maxpages)
+			{
+				pid = addpage();
 			}
-			else if (h < yrange.first() - y)
+			else
 			{
-				if (w >= MINLOSIZE && yrange.first() - y - h >= MINLOSIZE)
+				pid = leastrecent();
+
+				// The bitmap is skipped this frame, and a page is evicted once the frame was drawn.
+				if (pages[pid].lastuse == frame)
 				{
-					leftovers.add(rlid, Leftover(x, y + h, w, yrange.first() - y - h));
-					rlid++;
+					atlasfull = true;
+					return nullptr;
 				}
 
-				wasted += w * (yrange.first() - y - h);
+				evictpage(pid);
 			}
+
+			pages[pid].packer->insert(w, h, x, y);
 		}
 
-		//size_t used = ATLASW * border.y() + border.x() * yrange.second();
-		//double usedpercent = static_cast<double>(used) / (ATLASW * ATLASH);
-		//double wastedpercent = static_cast<double>(wasted) / used;
-		//Console::get().print("Used: " + std::to_string(usedpercent) + ", wasted: " + std::to_string(wastedpercent));
+		Page& page = pages[pid];
+		page.ids.push_back(id);
+		page.used += w * h;
+		page.lastuse = frame;
 
-		glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, w, h, GL_BGRA, GL_UNSIGNED_BYTE, bmp.data());
+		currentpage = pid;
 
-		return offsets.emplace(
+		backend->upload(pid, x, y, w, h, pixels);
+
+		return &offsets.emplace(
 			std::piecewise_construct,
 			std::forward_as_tuple(id),
-			std::forward_as_tuple(x, y, w, h)
+			std::forward_as_tuple(x, y, w, h, pid)
 		).first->second;
 	}
 
+	void GraphicsGL::usepage(uint8_t page)
+	{
+		pages[page].lastuse = frame;
+
+		if (runs.empty() || runs.back().page != page || runs.back().period.x() > 0)
+			runs.push_back({ quads.size(), page, nulloffset, Point<int16_t>() });
+	}
+
+	void GraphicsGL::endwrapped()
+	{
+		// Untextured quads look the same with any page, so the run keeps the page of the wrapped one.
+		if (!runs.empty() && runs.back().period.x() > 0)
+			runs.push_back({ quads.size(), runs.back().page, nulloffset, Point<int16_t>() });
+	}
+
 	void GraphicsGL::draw(const nl::bitmap& bmp, const Rectangle<int16_t>& rect, const Color& color, float angle)
 	{
-		if (locked)
+		if (color.invisible())
 			return;
 
-		if (color.invisible())
+		// Batches are built while maps load, which happens with the scene locked.
+		if (collecting)
+		{
+			collecting->add(bmp, rect, color, angle);
+			return;
+		}
+
+		if (locked)
 			return;
 
 		if (!rect.overlaps(SCREEN))
 			return;
 
-		quads.emplace_back(rect.l(), rect.r(), rect.t(), rect.b(), getoffset(bmp), color, angle);
+		const Offset* offset = findoffset(bmp);
+
+		// Bitmaps which are still being streamed are skipped until their upload lands.
+		if (!offset)
+			return;
+
+		usepage(offset->page);
+		quads.emplace_back(rect.l(), rect.r(), rect.t(), rect.b(), *offset, color, angle);
+	}
+
+	bool GraphicsGL::drawwrapped(const nl::bitmap& bmp, const Rectangle<int16_t>& rect, Point<int16_t> period, Point<int16_t> count, const Color& color)
+	{
+		// Batches only take single bitmaps.
+		if (collecting)
+			return false;
+
+		int16_t width = bmp.width();
+		int16_t height = bmp.height();
+
+		if (width <= 0 || height <= 0 || count.x() < 1 || count.y() < 1)
+			return true;
+
+		// Flipped or scaled tiles would need the texture coordinates of each tile to change.
+		if (rect.r() - rect.l() != width || rect.b() - rect.t() != height)
+			return false;
+
+		// An axis with a single tile does not repeat, so its period only has to span the tile.
+		if (count.x() == 1)
+			period.set_x(width);
+
+		if (count.y() == 1)
+			period.set_y(height);
+
+		// Overlapping tiles are blended onto each other, which one quad can not do.
+		if (period.x() < width || period.y() < height)
+			return false;
+
+		int32_t spanx = (count.x() - 1) * period.x() + width;
+		int32_t spany = (count.y() - 1) * period.y() + height;
+
+		if (rect.l() + spanx > INT16_MAX || rect.t() + spany > INT16_MAX)
+			return false;
+
+		if (color.invisible() || locked)
+			return true;
+
+		Rectangle<int16_t> area(rect.l(), rect.l() + spanx, rect.t(), rect.t() + spany);
+
+		if (!area.overlaps(SCREEN))
+			return true;
+
+		const Offset* offset = findoffset(bmp);
+
+		if (!offset)
+			return true;
+
+		// The texture coordinates continue past the bitmap and are wrapped back into it by the backend.
+		if (offset->l + spanx > INT16_MAX || offset->t + spany > INT16_MAX)
+			return false;
+
+		int16_t visiblex = 0;
+		int16_t visibley = 0;
+
+		for (int16_t i = 0; i < count.x(); i++)
+			if (rect.l() + i * period.x() < SCREEN.r() && rect.l() + i * period.x() + width > SCREEN.l())
+				visiblex++;
+
+		for (int16_t i = 0; i < count.y(); i++)
+			if (rect.t() + i * period.y() < SCREEN.b() && rect.t() + i * period.y() + height > SCREEN.t())
+				visibley++;
+
+		wrappedtiles += visiblex * visibley;
+
+		pages[offset->page].lastuse = frame;
+		runs.push_back({ quads.size(), offset->page, *offset, period });
+
+		Offset texcoords(offset->l, offset->t, spanx, spany, offset->page);
+		quads.emplace_back(area.l(), area.r(), area.t(), area.b(), texcoords, color, 0.0f);
+
+		return true;
+	}
+
+	void GraphicsGL::setbatch(StaticBatch* batch)
+	{
+		collecting = batch;
+	}
+
+	void GraphicsGL::drawbatch(const StaticBatch& source, Point<int16_t> offset)
+	{
+		if (locked)
+			return;
+
+		if (source.empty())
+			return;
+
+		Batch& batch = batches[source.get_id()];
+
+		if (batch.immediate)
+		{
+			batch.lastuse = frame;
+			drawunbatched(source, offset);
+			return;
+		}
+
+		// Bitmaps which were still being streamed, or were moved by an eviction, need new vertices.
+		// Without streaming, a batch is only incomplete if some of its bitmaps found no space.
+		bool failed = batch.stored && (isevicted(batch) || (!batch.complete && !streaming));
+
+		if (failed)
+			batch.failures++;
+		else
+			batch.failures = 0;
+
+		// Such a batch would be built again every frame, so it is drawn like single bitmaps from now on.
+		if (batch.failures >= MAXBATCHFAILURES)
+		{
+			backend->releasebatch(source.get_id());
+
+			batch.immediate = true;
+			batch.stored = false;
+			batch.count = 0;
+			batch.runs.clear();
+			batch.lastuse = frame;
+
+			drawunbatched(source, offset);
+			return;
+		}
+
+		if (!batch.stored || !batch.complete || failed)
+			buildbatch(source, batch);
+
+		for (auto& run : batch.runs)
+			pages[run.page].lastuse = frame;
+
+		batchdraws.push_back({ quads.size(), source.get_id(), offset });
+	}
+
+	bool GraphicsGL::isevicted(const Batch& batch) const
+	{
+		for (auto& run : batch.runs)
+			if (pages[run.page].evictions != batch.evictions[run.page])
+				return true;
+
+		return false;
 	}
 
-	Text::Layout GraphicsGL::createlayout(const std::string& text, Text::Font id, Text::Alignment alignment, int16_t maxwidth, bool formatted, int16_t line_adj)
+	void GraphicsGL::drawunbatched(const StaticBatch& source, Point<int16_t> offset)
+	{
+		for (auto& sprite : source.get_sprites())
+		{
+			Rectangle<int16_t> rect = sprite.rect;
+			rect.shift(offset);
+
+			draw(sprite.bitmap, rect, sprite.color, sprite.angle);
+		}
+	}
+
+	void GraphicsGL::buildbatch(const StaticBatch& source, Batch& batch)
+	{
+		std::vector<Quad> batchquads;
+		batch.runs.clear();
+		batch.complete = true;
+
+		for (auto& sprite : source.get_sprites())
+		{
+			const Offset* offset = findoffset(sprite.bitmap);
+
+			if (!offset)
+			{
+				batch.complete = false;
+				continue;
+			}
+
+			// Later bitmaps of the batch must not evict the pages which hold the earlier ones.
+			pages[offset->page].lastuse = frame;
+
+			if (batch.runs.empty() || batch.runs.back().page != offset->page)
+				batch.runs.push_back({ batchquads.size(), offset->page, nulloffset, Point<int16_t>() });
+
+			const Rectangle<int16_t>& rect = sprite.rect;
+			batchquads.emplace_back(rect.l(), rect.r(), rect.t(), rect.b(), *offset, sprite.color, sprite.angle);
+		}
+
+		backend->storebatch(source.get_id(), batchquads.data(), batchquads.size());
+
+		batch.stored = true;
+		batch.count = batchquads.size();
+		batch.evictions.clear();
+
+		for (auto& page : pages)
+			batch.evictions.push_back(page.evictions);
+	}
+
+	LayoutCache::Layout GraphicsGL::createlayout(const std::string& text, Text::Font id, Text::Alignment alignment, int16_t maxwidth, bool formatted, int16_t line_adj)
 	{
 		size_t length = text.length();
 
 		if (length == 0)
-			return{};
+			return std::make_shared<const Text::Layout>();
+
+		LayoutCache::Key key = { text, id, alignment, maxwidth, formatted, line_adj };
+
+		if (auto layout = layouts.find(key))
+			return layout;
 
-		LayoutBuilder builder(fonts[id], alignment, maxwidth, formatted, line_adj);
+		LayoutBuilder builder(fonts[id], glyphs, id, alignment, maxwidth, formatted, line_adj);
 
 		const char* p_text = text.c_str();
 
@@ -461,10 +705,13 @@ namespace jrc
 			offset = last;
 		}
 
-		return builder.finish(first, offset);
+		auto layout = std::make_shared<const Text::Layout>(builder.finish(first, offset));
+		layouts.insert(key, layout);
+
+		return layout;
 	}
 
-	GraphicsGL::LayoutBuilder::LayoutBuilder(const Font& f, Text::Alignment a, int16_t mw, bool fm, int16_t la) : font(f), alignment(a), maxwidth(mw), formatted(fm), line_adj(la)
+	GraphicsGL::LayoutBuilder::LayoutBuilder(const Font& f, GlyphCache& g, Text::Font gf, Text::Alignment a, int16_t mw, bool fm, int16_t la) : font(f), glyphs(g), glyphfont(gf), alignment(a), maxwidth(mw), formatted(fm), line_adj(la)
 	{
 		fontid = Text::NUM_FONTS;
 		color = Text::NUM_COLORS;
@@ -540,23 +787,28 @@ namespace jrc
 
 		if (!linebreak)
 		{
-			for (size_t i = first; i < last; i++)
+			for (size_t i = first; i < last;)
 			{
-				char c = text[i];
-				wordwidth += font.chars[c].ax;
+				size_t next = i;
+				wordwidth += glyphs.get(glyphfont, utf8::decode(text, last, next)).advance;
 
 				if (wordwidth > maxwidth)
 				{
-					if (last - first == 1)
+					if (i == first && next == last)
 					{
 						return last;
 					}
 					else
 					{
-						prev = add(text, prev, first, i);
-						return add(text, prev, i, last);
+						// Words are only split between code points.
+						size_t split = i > first ? i : next;
+
+						prev = add(text, prev, first, split);
+						return add(text, prev, split, last);
 					}
 				}
+
+				i = next;
 			}
 		}
 
@@ -578,17 +830,19 @@ namespace jrc
 				ay -= line_adj;
 		}
 
-		for (size_t pos = first; pos < last; pos++)
+		for (size_t pos = first; pos < last;)
 		{
-			char c = text[pos];
-			const Font::Char& ch = font.chars[c];
+			size_t start = pos;
+			char32_t c = utf8::decode(text, last, pos);
 
-			advances.push_back(ax);
+			// Every byte of a code point has the same advance, so that layouts stay indexed by byte.
+			for (size_t i = start; i < pos; i++)
+				advances.push_back(ax);
 
-			if (pos < first + skip || newline && c == ' ')
+			if (start < first + skip || newline && c == ' ')
 				continue;
 
-			ax += ch.ax;
+			ax += glyphs.get(glyphfont, c).advance;
 
 			if (width < ax)
 				width = ax;
@@ -646,6 +900,8 @@ namespace jrc
 
 		const Font& font = fonts[id];
 
+		usepage(0);
+
 		GLshort x = args.getpos().x();
 		GLshort y = args.getpos().y();
 		GLshort w = layout.width();
@@ -718,25 +974,32 @@ namespace jrc
 
 				Color abscolor = color * Color{ wordcolor[0], wordcolor[1], wordcolor[2], 1.0f };
 
-				for (size_t pos = word.first; pos < word.last; ++pos)
+				for (size_t pos = word.first; pos < word.last;)
 				{
-					const char c = text[pos];
-					const Font::Char& ch = font.chars[c];
+					const char32_t c = utf8::decode(text.c_str(), word.last, pos);
+					const GlyphCache::Glyph& ch = glyphs.get(id, c);
 
-					GLshort chx = x + ax + ch.bl;
-					GLshort chy = y + ay - ch.bt;
-					GLshort chw = ch.bw;
-					GLshort chh = ch.bh;
+					GLshort chx = x + ax + ch.left;
+					GLshort chy = y + ay - ch.top;
+					GLshort chw = ch.width;
+					GLshort chh = ch.height;
 
 					if (ax == 0 && c == ' ')
 						continue;
 
-					ax += ch.ax;
+					ax += ch.advance;
 
 					if (chw <= 0 || chh <= 0)
 						continue;
 
-					quads.emplace_back(chx, chx + chw, chy, chy + chh, ch.offset, abscolor, 0.0f);
+					// Glyphs which do not fit into the atlas this frame are skipped.
+					const GlyphCache::Glyph* placed = glyphs.place(id, c);
+
+					if (!placed)
+						continue;
+
+					Offset offset = Offset(placed->x, placed->y, chw, chh);
+					quads.emplace_back(chx, chx + chw, chy, chy + chh, offset, abscolor, 0.0f);
 				}
 			}
 		}
@@ -747,6 +1010,7 @@ namespace jrc
 		if (locked)
 			return;
 
+		endwrapped();
 		quads.emplace_back(x, x + w, y, y + h, nulloffset, Color{ r, g, b, a }, 0.0f);
 	}
 
@@ -767,40 +1031,156 @@ namespace jrc
 
 	void GraphicsGL::flush(float opacity)
 	{
+		if (streaming)
+			uploadstreamed();
+
 		bool coverscene = opacity != 1.0f;
+		size_t sceneruns = runs.size();
 
 		if (coverscene)
 		{
 			float complement = 1.0f - opacity;
 			Color color{ 0.0f, 0.0f, 0.0f, complement };
 
+			endwrapped();
 			quads.emplace_back(SCREEN.l(), SCREEN.r(), SCREEN.t(), SCREEN.b(), nulloffset, color, 0.0f);
 		}
 
-		glClearColor(1.0, 1.0, 1.0, 1.0);
-		glClear(GL_COLOR_BUFFER_BIT);
+		drawstats.quads = quads.size();
+		drawstats.bytes = quads.size() * sizeof(Quad);
+		drawstats.batchquads = 0;
+		drawstats.wrappedquads = 0;
+		drawstats.wrappedtiles = wrappedtiles;
+
+		for (auto& run : runs)
+			if (run.period.x() > 0)
+				drawstats.wrappedquads++;
+
+		// Batches are drawn with the same index buffer, so it has to cover the largest one.
+		size_t maxquads = quads.size();
 
-		GLsizei csize = static_cast<GLsizei>(quads.size() * sizeof(Quad));
-		GLsizei fsize = static_cast<GLsizei>(quads.size() * Quad::LENGTH);
+		for (auto& draw : batchdraws)
+		{
+			auto iter = batches.find(draw.id);
+
+			if (iter == batches.end())
+				continue;
 
-		glEnableVertexAttribArray(attribute_coord);
-		glEnableVertexAttribArray(attribute_color);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo);
-		glBufferData(GL_ARRAY_BUFFER, csize, quads.data(), GL_STREAM_DRAW);
+			size_t count = iter->second.count;
+
+			drawstats.batchquads += count;
+			maxquads = std::max(maxquads, count);
+		}
 
-		glDrawArrays(GL_QUADS, 0, fsize);
+		backend->begin(quads.data(), quads.size(), maxquads);
 
-		glDisableVertexAttribArray(attribute_coord);
-		glDisableVertexAttribArray(attribute_color);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		// Quads before the first run do not sample the atlas, so they are drawn with it.
+		size_t numruns = std::max<size_t>(runs.size(), 1);
+		size_t nextdraw = 0;
+
+		for (size_t i = 0; i < numruns; i++)
+		{
+			size_t first = i > 0 ? runs[i].first : 0;
+			size_t last = i + 1 < runs.size() ? runs[i + 1].first : quads.size();
+			Run run = runs.empty() ? Run{ 0, 0, nulloffset, Point<int16_t>() } : runs[i];
+
+			// Batches are drawn in between the quads which were added before and after them.
+			for (; nextdraw < batchdraws.size() && batchdraws[nextdraw].first < last; nextdraw++)
+			{
+				size_t split = std::max(batchdraws[nextdraw].first, first);
+
+				flushquads(first, split, run);
+				flushbatch(batchdraws[nextdraw]);
+
+				first = split;
+			}
+
+			flushquads(first, last, run);
+		}
 
+		for (; nextdraw < batchdraws.size(); nextdraw++)
+			flushbatch(batchdraws[nextdraw]);
+
+		backend->end();
+
+		glyphs.nextframe();
+		frame++;
+
+		// No page is drawn from yet, so one can be evicted for the bitmaps which found no space.
+		if (atlasfull)
+		{
+			evictpage(leastrecent());
+			atlasfull = false;
+		}
+
+		// Release the vertices of batches which are no longer drawn, such as the tiles of the previous map.
+		for (auto iter = batches.begin(); iter != batches.end();)
+		{
+			if (iter->second.lastuse + BATCHLIFETIME < frame)
+			{
+				backend->releasebatch(iter->first);
+				iter = batches.erase(iter);
+			}
+			else
+			{
+				iter++;
+			}
+		}
+
+		// The scene may be drawn again while it is locked, so the cover is removed with its run.
 		if (coverscene)
+		{
 			quads.pop_back();
+			runs.resize(sceneruns);
+		}
+	}
+
+	void GraphicsGL::flushquads(size_t first, size_t last, const Run& run)
+	{
+		pages[run.page].lastuse = frame;
+
+		if (first == last)
+			return;
+
+		if (run.period.x() > 0)
+			backend->drawwrapped(first, last, run.region, run.period);
+		else
+			backend->drawquads(first, last, run.page);
+	}
+
+	void GraphicsGL::flushbatch(const BatchDraw& draw)
+	{
+		auto iter = batches.find(draw.id);
+
+		if (iter == batches.end())
+			return;
+
+		Batch& batch = iter->second;
+		batch.lastuse = frame;
+
+		if (batch.count == 0)
+			return;
+
+		for (size_t i = 0; i < batch.runs.size(); i++)
+		{
+			size_t first = batch.runs[i].first;
+			size_t last = i + 1 < batch.runs.size() ? batch.runs[i + 1].first : batch.count;
+			uint8_t pid = batch.runs[i].page;
+
+			pages[pid].lastuse = frame;
+
+			backend->drawbatch(draw.id, first, last, pid, draw.offset);
+		}
 	}
 
 	void GraphicsGL::clearscene()
 	{
 		if (!locked)
+		{
 			quads.clear();
+			runs.clear();
+			batchdraws.clear();
+			wrappedtiles = 0;
+		}
 	}
 }
\ No newline at end of file
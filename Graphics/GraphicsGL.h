@@ -16,12 +16,20 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
 //////////////////////////////////////////////////////////////////////////////
 #pragma once
+#include "AtlasPacker.h"
+#include "BakedTextures.h"
+#include "BitmapCache.h"
 #include "DrawArgument.h"
+#include "GlyphCache.h"
+#include "LayoutCache.h"
+#include "Quad.h"
+#include "RenderBackend.h"
+#include "StaticBatch.h"
 #include "Text.h"
+#include "TextureStreamer.h"
 
 #include "../Constants.h"
 #include "../Error.h"
-#include "../Util/QuadTree.h"
 #include "../Template/Rectangle.h"
 #include "../Template/Singleton.h"
 
@@ -29,35 +37,47 @@
 
 #include "GL/glew.h"
 
-#include "ft2build.h"
-#include FT_FREETYPE_H
-
+#include <algorithm>
+#include <cmath>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
 namespace jrc
 {
-	// Graphics engine which uses OpenGL.
+	// Graphics engine. Keeps the texture atlas and builds the quads of each frame, which are drawn by a render backend.
 	class GraphicsGL : public Singleton<GraphicsGL>
 	{
 	public:
 		GraphicsGL();
 
-		// Initialise all resources.
+		// Initialise all resources and draw with OpenGL.
 		Error init();
+		// Initialise all resources and draw with the given backend.
+		Error init(std::unique_ptr<RenderBackend> backend);
 		// Re-initialise after changing screen modes.
 		void reinit();
+		// Stop background work. Must be called before the game files are closed.
+		void close();
 
-		// Clear all bitmaps if most of the space is used up.
+		// Evict the atlas pages which are mostly used up and were not drawn from this frame.
 		void clear();
 
 		// Add a bitmap to the available resources.
 		void addbitmap(const nl::bitmap& bmp);
 		// Draw the bitmap with the given parameters.
 		void draw(const nl::bitmap& bmp, const Rectangle<int16_t>& rect, const Color& color, float angle);
+		// Draw count tiles of a bitmap, one every period pixels starting with the tile at rect, as a single quad.
+		// Returns false if the tiles can not be drawn that way, because they are flipped, scaled or overlap.
+		bool drawwrapped(const nl::bitmap& bmp, const Rectangle<int16_t>& rect, Point<int16_t> period, Point<int16_t> count, const Color& color);
+
+		// Add the bitmaps of following draw calls to the batch instead of drawing them. Stops when null.
+		void setbatch(StaticBatch* batch);
+		// Draw a batch of bitmaps which never move, shifted by the offset.
+		void drawbatch(const StaticBatch& batch, Point<int16_t> offset);
 
-		// Create a layout for the text with the parameters specified.
-		Text::Layout createlayout(const std::string& text, Text::Font font, Text::Alignment alignment, int16_t maxwidth, bool formatted, int16_t line_adj);
+		// Return the layout for the text with the parameters specified. Layouts are shared between equal texts.
+		LayoutCache::Layout createlayout(const std::string& text, Text::Font font, Text::Alignment alignment, int16_t maxwidth, bool formatted, int16_t line_adj);
 		// Draw a text with the given parameters.
 		void drawtext(const DrawArgument& args, const std::string& text, const Text::Layout& layout, Text::Font font, Text::Color color, Text::Background back);
 
@@ -76,139 +96,144 @@ namespace jrc
 		// Clear the buffer contents.
 		void clearscene();
 
-	private:
-		void clearinternal();
-		bool addfont(const char* name, Text::Font id, FT_UInt width, FT_UInt height);
-
-		struct Offset
+		// Counters for the texture streaming pipeline.
+		struct StreamStats
 		{
-			GLshort l;
-			GLshort r;
-			GLshort t;
-			GLshort b;
-
-			Offset(GLshort x, GLshort y, GLshort w, GLshort h)
-			{
-				l = x;
-				r = x + w;
-				t = y;
-				b = y + h;
-			}
+			size_t queued;
+			size_t upload_bytes;
+			size_t upload_count;
+		};
 
-			Offset()
-			{
-				l = 0;
-				r = 0;
-				t = 0;
-				b = 0;
-			}
+		// Counters for the vertices submitted by flush.
+		struct DrawStats
+		{
+			size_t quads;
+			size_t bytes;
+			size_t batchquads;
+			size_t wrappedquads;
+			// The visible tiles of the wrapped quads, each of which would otherwise be a quad of its own.
+			size_t wrappedtiles;
 		};
 
-		// Add a bitmap to the available resources.
-		const Offset& getoffset(const nl::bitmap& bmp);
+		// Return the streaming counters of the last frame.
+		const StreamStats& get_streamstats() const;
+		// Return the number of streamed quads, their bytes, the quads drawn from batches and the wrapped quads in the last frame.
+		const DrawStats& get_drawstats() const;
 
-		struct Leftover
+		// Occupancy of one page of the texture atlas.
+		struct PageStats
 		{
-			GLshort l;
-			GLshort r;
-			GLshort t;
-			GLshort b;
+			size_t bitmaps;
+			size_t used;
+			size_t wasted;
+			size_t evictions;
+			double occupancy;
+		};
 
-			Leftover(GLshort x, GLshort y, GLshort w, GLshort h)
-			{
-				l = x;
-				r = x + w;
-				t = y;
-				b = y + h;
-			}
+		// Return the occupancy of each atlas page.
+		std::vector<PageStats> get_atlasstats() const;
+		// Return the hit, miss and eviction counters of the decoded bitmap cache.
+		BitmapCache::Stats get_cachestats() const;
+		// Return the hit, miss and eviction counters of the layout cache.
+		LayoutCache::Stats get_layoutstats() const;
 
-			Leftover()
-			{
-				l = 0;
-				r = 0;
-				t = 0;
-				b = 0;
-			}
+		// Build frames of the given number of quads, with and without rotation,
+		// and print the quads built per millisecond and the vertex bytes per frame.
+		static void benchmark(size_t count);
 
-			GLshort width() const
-			{
-				return r - l;
-			}
+	private:
+		void clearinternal();
 
-			GLshort height() const
-			{
-				return b - t;
-			}
+		using Offset = Quad::Offset;
+
+		// Add a bitmap to the available resources. Returns null if there is no space for it this frame.
+		const Offset* getoffset(const nl::bitmap& bmp);
+		// Return the offset of a bitmap, or request it from the streamer and return null if it is not uploaded yet.
+		const Offset* findoffset(const nl::bitmap& bmp);
+		// Find space in the atlas and upload the pixels there.
+		// Returns null if every page is full and was drawn from this frame, so none can be evicted.
+		const Offset* addoffset(size_t id, GLshort w, GLshort h, const void* pixels);
+		// Start a new draw run if the next quads use a different atlas page than the previous ones.
+		void usepage(uint8_t page);
+		// Start a new draw run if the previous one is a wrapped quad, so that untextured quads are not wrapped.
+		void endwrapped();
+		// Upload decoded bitmaps from the streamer within the per-frame budget.
+		void uploadstreamed();
+
+		// One texture of the atlas. Every page keeps the font region at the top free,
+		// so that the shader can tell glyphs and bitmaps apart on all of them.
+		struct Page
+		{
+			std::unique_ptr<AtlasPacker> packer;
+			size_t used;
+			size_t evictions;
+			uint64_t lastuse;
+			std::vector<size_t> ids;
 		};
 
-		struct Quad
+		// Quads from first until the next run are drawn with the texture of the page.
+		// If the period is not zero, the run is a wrapped quad which repeats the region.
+		struct Run
 		{
-			struct Vertex
-			{
-				GLshort x;
-				GLshort y;
-				GLshort s;
-				GLshort t;
-
-				Color c;
-			};
+			size_t first;
+			uint8_t page;
+			Offset region;
+			Point<int16_t> period;
+		};
 
-			static const size_t LENGTH = 4;
-			Vertex vertices[LENGTH];
+		// The vertices of a static batch, kept by the backend while the batch is drawn.
+		struct Batch
+		{
+			bool stored;
+			size_t count;
+			std::vector<Run> runs;
+			// The eviction counters of all pages when the batch was built.
+			std::vector<size_t> evictions;
+			uint64_t lastuse;
+			bool complete;
+			// Builds in a row which were undone by an eviction or did not fit into the atlas.
+			uint8_t failures;
+			// The batch is drawn one bitmap at a time, because it does not fit into the atlas next to everything else.
+			bool immediate;
+		};
 
-			Quad(GLshort l, GLshort r, GLshort t, GLshort b, const Offset& o, const Color& color, GLfloat rot)
-			{
-				vertices[0] = { l, t, o.l, o.t, color };
-				vertices[1] = { l, b, o.l, o.b, color };
-				vertices[2] = { r, b, o.r, o.b, color };
-				vertices[3] = { r, t, o.r, o.t, color };
-
-				if (rot != 0.0f)
-				{
-					float cos = std::cos(rot);
-					float sin = std::sin(rot);
-					GLshort cx = (l + r) / 2;
-					GLshort cy = (t + b) / 2;
-
-					for (int i = 0; i < 4; i++)
-					{
-						GLshort vx = vertices[i].x - cx;
-						GLshort vy = vertices[i].y - cy;
-						GLfloat rx = std::roundf(vx * cos - vy * sin);
-						GLfloat ry = std::roundf(vx * sin + vy * cos);
-						vertices[i].x = static_cast<GLshort>(rx + cx);
-						vertices[i].y = static_cast<GLshort>(ry + cy);
-					}
-				}
-			}
+		// A batch which is drawn before the quad at first.
+		struct BatchDraw
+		{
+			size_t first;
+			size_t id;
+			Point<int16_t> offset;
 		};
 
+		// Upload the vertices of a batch with the current atlas offsets of its bitmaps.
+		void buildbatch(const StaticBatch& source, Batch& batch);
+		// Return true if a page which the batch uses was evicted after it was built.
+		bool isevicted(const Batch& batch) const;
+		// Draw the bitmaps of a batch like any other bitmaps.
+		void drawunbatched(const StaticBatch& source, Point<int16_t> offset);
+		// Draw the streamed quads from first to last as specified by their run.
+		void flushquads(size_t first, size_t last, const Run& run);
+		// Draw a batch from its own vertex buffer.
+		void flushbatch(const BatchDraw& draw);
+
+		// Create a new page and return its index.
+		uint8_t addpage();
+		// Return the index of the page which was drawn from least recently.
+		uint8_t leastrecent() const;
+		// Remove all bitmaps from a page, so that its space can be reused.
+		void evictpage(uint8_t page);
+
 		struct Font
 		{
-			struct Char
-			{
-				GLshort ax;
-				GLshort ay;
-				GLshort bw;
-				GLshort bh;
-				GLshort bl;
-				GLshort bt;
-				Offset offset;
-			};
-
-			GLshort width;
 			GLshort height;
-			Char chars[128];
 
-			Font(GLshort w, GLshort h)
+			Font(GLshort h)
 			{
-				width = w;
 				height = h;
 			}
 
 			Font()
 			{
-				width = 0;
 				height = 0;
 			}
 
@@ -221,7 +246,7 @@ namespace jrc
 		class LayoutBuilder
 		{
 		public:
-			LayoutBuilder(const Font& font, Text::Alignment alignment, int16_t maxwidth, bool formatted, int16_t line_adj);
+			LayoutBuilder(const Font& font, GlyphCache& glyphs, Text::Font glyphfont, Text::Alignment alignment, int16_t maxwidth, bool formatted, int16_t line_adj);
 
 			size_t add(const char* text, size_t prev, size_t first, size_t last);
 			Text::Layout finish(size_t first, size_t last);
@@ -231,6 +256,8 @@ namespace jrc
 			void add_line();
 
 			const Font& font;
+			GlyphCache& glyphs;
+			Text::Font glyphfont;
 
 			Text::Alignment alignment;
 			Text::Font fontid;
@@ -255,35 +282,49 @@ namespace jrc
 
 		static const GLshort ATLASW = 8192;
 		static const GLshort ATLASH = 8192;
-		static const GLshort MINLOSIZE = 32;
+
+		static const uint64_t BATCHLIFETIME = 300;
+		static const uint8_t MAXBATCHFAILURES = 2;
+		// Upper limits for the per-frame upload budget settings.
+		static const size_t MAXUPLOADKB = 65536;
+		static const size_t MAXUPLOADCOUNT = 1024;
+		// Height of the glyph rows at the top of the first page.
+		static const GLshort GLYPHREGION = 256;
 
 		bool locked;
 
 		std::vector<Quad> quads;
-		GLuint vbo;
-		GLuint atlas;
-
-		GLint program;
-		GLint attribute_coord;
-		GLint attribute_color;
-		GLint uniform_texture;
-		GLint uniform_atlassize;
-		GLint uniform_screensize;
-		GLint uniform_yoffset;
-		GLint uniform_fontregion;
+		std::vector<Run> runs;
+		DrawStats drawstats;
+		size_t wrappedtiles;
+
+		std::unique_ptr<RenderBackend> backend;
 
 		std::unordered_map<size_t, Offset> offsets;
 		Offset nulloffset;
 
-		QuadTree<size_t, Leftover> leftovers;
-		size_t rlid;
-		size_t wasted;
-		Point<GLshort> border;
-		Range<GLshort> yrange;
-
-		FT_Library ftlibrary;
+		std::vector<Page> pages;
+		AtlasPacker::Type packertype;
+		uint8_t maxpages;
+		uint8_t currentpage;
+		uint64_t frame;
+		bool atlasfull;
+
+		std::unordered_map<size_t, Batch> batches;
+		std::vector<BatchDraw> batchdraws;
+		StaticBatch* collecting;
+
+		BitmapCache bitmapcache;
+		BakedTextures bakedtextures;
+		TextureStreamer streamer;
+		bool streaming;
+		size_t upload_budget_bytes;
+		size_t upload_budget_count;
+		StreamStats streamstats;
+
+		GlyphCache glyphs;
+		LayoutCache layouts;
 		Font fonts[Text::Font::NUM_FONTS];
-		Point<GLshort> fontborder;
 		GLshort fontymax;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,431 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#include "HeadlessBackend.h"
+
+#include "../Constants.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace jrc
+{
+	namespace
+	{
+		uint32_t crc32(const uint8_t* data, size_t length, uint32_t crc)
+		{
+			static uint32_t table[256] = {};
+
+			if (!table[1])
+			{
+				for (uint32_t i = 0; i < 256; i++)
+				{
+					uint32_t c = i;
+
+					for (int k = 0; k < 8; k++)
+						c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+
+					table[i] = c;
+				}
+			}
+
+			crc = ~crc;
+
+			for (size_t i = 0; i < length; i++)
+				crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+
+			return ~crc;
+		}
+
+		void write32(std::vector<uint8_t>& out, uint32_t value)
+		{
+			out.push_back(static_cast<uint8_t>(value >> 24));
+			out.push_back(static_cast<uint8_t>(value >> 16));
+			out.push_back(static_cast<uint8_t>(value >> 8));
+			out.push_back(static_cast<uint8_t>(value));
+		}
+
+		void writechunk(std::ostream& stream, const char* type, const std::vector<uint8_t>& data)
+		{
+			std::vector<uint8_t> chunk;
+			write32(chunk, static_cast<uint32_t>(data.size()));
+			chunk.insert(chunk.end(), type, type + 4);
+			chunk.insert(chunk.end(), data.begin(), data.end());
+			write32(chunk, crc32(chunk.data() + 4, chunk.size() - 4, 0));
+
+			stream.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+		}
+	}
+
+	HeadlessBackend::HeadlessBackend(bool rasterize)
+	{
+		rasterizing = rasterize;
+		atlaswidth = 0;
+		atlasheight = 0;
+		screenwidth = 0;
+		screenheight = 0;
+		fontregion = 0;
+		stream = nullptr;
+		streamcount = 0;
+	}
+
+	Error HeadlessBackend::init(int16_t aw, int16_t ah)
+	{
+		atlaswidth = aw;
+		atlasheight = ah;
+
+		return Error::NONE;
+	}
+
+	void HeadlessBackend::reinit(int16_t sw, int16_t sh, int16_t fr)
+	{
+		screenwidth = sw;
+		screenheight = sh;
+		fontregion = fr;
+
+		if (rasterizing)
+			screen.assign(static_cast<size_t>(sw) * sh * 4, 255);
+	}
+
+	void HeadlessBackend::close()
+	{
+		pages.clear();
+		batches.clear();
+		drawn.clear();
+	}
+
+	void HeadlessBackend::addpage()
+	{
+		size_t size = rasterizing ? static_cast<size_t>(atlaswidth) * atlasheight * 4 : 0;
+
+		// Texels which were never uploaded are transparent, like an uninitialised texture usually is.
+		pages.emplace_back(size, 0);
+	}
+
+	void HeadlessBackend::upload(uint8_t page, int16_t x, int16_t y, int16_t width, int16_t height, const void* pixels)
+	{
+		if (!rasterizing || !pixels)
+			return;
+
+		auto source = static_cast<const uint8_t*>(pixels);
+		auto& target = pages[page];
+
+		for (int16_t row = 0; row < height; row++)
+		{
+			size_t offset = (static_cast<size_t>(y + row) * atlaswidth + x) * 4;
+			std::copy(source + row * width * 4, source + (row + 1) * width * 4, target.begin() + offset);
+		}
+	}
+
+	void HeadlessBackend::uploadglyph(uint8_t page, int16_t x, int16_t y, int16_t width, int16_t height, int32_t pitch, const void* pixels)
+	{
+		if (!rasterizing || !pixels)
+			return;
+
+		auto source = static_cast<const uint8_t*>(pixels);
+		auto& target = pages[page];
+
+		// Like a red upload into an RGBA texture, which leaves green and blue at zero and alpha at one.
+		for (int16_t row = 0; row < height; row++)
+		{
+			for (int16_t col = 0; col < width; col++)
+			{
+				uint8_t* texel = &target[(static_cast<size_t>(y + row) * atlaswidth + x + col) * 4];
+
+				texel[0] = 0;
+				texel[1] = 0;
+				texel[2] = source[row * pitch + col];
+				texel[3] = 255;
+			}
+		}
+	}
+
+	void HeadlessBackend::storebatch(size_t id, const Quad* quads, size_t count)
+	{
+		batches[id].assign(quads, quads + count);
+	}
+
+	void HeadlessBackend::releasebatch(size_t id)
+	{
+		batches.erase(id);
+	}
+
+	void HeadlessBackend::begin(const Quad* quads, size_t count, size_t)
+	{
+		stream = quads;
+		streamcount = count;
+
+		drawn.clear();
+
+		if (rasterizing)
+			std::fill(screen.begin(), screen.end(), 255);
+	}
+
+	void HeadlessBackend::drawquads(size_t first, size_t last, uint8_t page)
+	{
+		for (size_t i = first; i < last && i < streamcount; i++)
+			record(stream[i], page, {});
+	}
+
+	void HeadlessBackend::drawwrapped(size_t first, size_t last, const Quad::Offset& region, Point<int16_t> period)
+	{
+		for (size_t i = first; i < last && i < streamcount; i++)
+		{
+			drawn.push_back({ stream[i], region.page, region, period });
+
+			if (rasterizing)
+				rasterize(drawn.back());
+		}
+	}
+
+	void HeadlessBackend::drawbatch(size_t id, size_t first, size_t last, uint8_t page, Point<int16_t> offset)
+	{
+		auto iter = batches.find(id);
+
+		if (iter == batches.end())
+			return;
+
+		const std::vector<Quad>& quads = iter->second;
+
+		for (size_t i = first; i < last && i < quads.size(); i++)
+			record(quads[i], page, offset);
+	}
+
+	void HeadlessBackend::end()
+	{
+		stream = nullptr;
+		streamcount = 0;
+	}
+
+	const std::vector<HeadlessBackend::DrawnQuad>& HeadlessBackend::get_quads() const
+	{
+		return drawn;
+	}
+
+	void HeadlessBackend::dump(std::ostream& out) const
+	{
+		for (auto& drawnquad : drawn)
+		{
+			const Quad::Vertex* vertices = drawnquad.quad.vertices;
+
+			out << static_cast<int>(drawnquad.page);
+
+			for (size_t i = 0; i < Quad::LENGTH; i++)
+				out << " " << vertices[i].x << "," << vertices[i].y << ":" << vertices[i].s << "," << vertices[i].t;
+
+			out << " " << std::hex << vertices[0].c << std::dec;
+
+			const Quad::Offset& region = drawnquad.region;
+
+			if (drawnquad.period.x() > 0)
+				out << " wrap " << region.l << "," << region.t << "," << region.r - region.l << "," << region.b - region.t
+					<< "/" << drawnquad.period.x() << "," << drawnquad.period.y();
+
+			out << "\n";
+		}
+	}
+
+	bool HeadlessBackend::writepng(const std::string& filename) const
+	{
+		if (!rasterizing || screen.empty())
+			return false;
+
+		std::ofstream file(filename, std::ios::binary);
+
+		if (!file)
+			return false;
+
+		const uint8_t SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+		file.write(reinterpret_cast<const char*>(SIGNATURE), 8);
+
+		std::vector<uint8_t> header;
+		write32(header, screenwidth);
+		write32(header, screenheight);
+		header.insert(header.end(), { 8, 6, 0, 0, 0 });
+		writechunk(file, "IHDR", header);
+
+		// Every row starts with filter type zero. The rows are stored in uncompressed deflate blocks.
+		size_t rowbytes = static_cast<size_t>(screenwidth) * 4;
+		std::vector<uint8_t> raw;
+		raw.reserve((rowbytes + 1) * screenheight);
+
+		for (int16_t y = 0; y < screenheight; y++)
+		{
+			raw.push_back(0);
+			raw.insert(raw.end(), screen.begin() + y * rowbytes, screen.begin() + (y + 1) * rowbytes);
+		}
+
+		std::vector<uint8_t> data = { 0x78, 0x01 };
+		uint32_t a = 1;
+		uint32_t b = 0;
+
+		for (uint8_t byte : raw)
+		{
+			a = (a + byte) % 65521;
+			b = (b + a) % 65521;
+		}
+
+		for (size_t pos = 0; pos < raw.size() || pos == 0; pos += 65535)
+		{
+			size_t length = std::min<size_t>(raw.size() - pos, 65535);
+			bool last = pos + length == raw.size();
+
+			data.push_back(last ? 1 : 0);
+			data.push_back(static_cast<uint8_t>(length));
+			data.push_back(static_cast<uint8_t>(length >> 8));
+			data.push_back(static_cast<uint8_t>(~length));
+			data.push_back(static_cast<uint8_t>(~length >> 8));
+			data.insert(data.end(), raw.begin() + pos, raw.begin() + pos + length);
+
+			if (last)
+				break;
+		}
+
+		write32(data, (b << 16) | a);
+		writechunk(file, "IDAT", data);
+		writechunk(file, "IEND", {});
+
+		return file.good();
+	}
+
+	void HeadlessBackend::record(const Quad& quad, uint8_t page, Point<int16_t> offset)
+	{
+		drawn.push_back({ quad, page, {}, {} });
+
+		Quad& moved = drawn.back().quad;
+
+		for (auto& vertex : moved.vertices)
+		{
+			vertex.x += offset.x();
+			vertex.y += offset.y();
+		}
+
+		if (rasterizing)
+			rasterize(drawn.back());
+	}
+
+	void HeadlessBackend::rasterize(const DrawnQuad& drawnquad)
+	{
+		// Quads are parallelograms, so each pixel center is mapped back onto the edges at the first vertex.
+		const Quad::Vertex* v = drawnquad.quad.vertices;
+		uint8_t page = drawnquad.page;
+		const Quad::Offset& region = drawnquad.region;
+		Point<int16_t> period = drawnquad.period;
+		bool wrapped = period.x() > 0;
+		float yoffset = Constants::VIEWYOFFSET;
+
+		float x0 = v[0].x;
+		float y0 = v[0].y + yoffset;
+		float ux = v[1].x - v[0].x;
+		float uy = v[1].y - v[0].y;
+		float wx = v[3].x - v[0].x;
+		float wy = v[3].y - v[0].y;
+		float det = ux * wy - uy * wx;
+
+		if (det == 0.0f)
+			return;
+
+		int32_t left = screenwidth;
+		int32_t right = 0;
+		int32_t top = screenheight;
+		int32_t bottom = 0;
+
+		for (size_t i = 0; i < Quad::LENGTH; i++)
+		{
+			left = std::min<int32_t>(left, v[i].x);
+			right = std::max<int32_t>(right, v[i].x);
+			top = std::min<int32_t>(top, static_cast<int32_t>(v[i].y + yoffset));
+			bottom = std::max<int32_t>(bottom, static_cast<int32_t>(v[i].y + yoffset));
+		}
+
+		left = std::max<int32_t>(left, 0);
+		top = std::max<int32_t>(top, 0);
+		right = std::min<int32_t>(right, screenwidth);
+		bottom = std::min<int32_t>(bottom, screenheight);
+
+		bool textured = v[0].t != 0 || v[1].t != 0 || v[2].t != 0 || v[3].t != 0;
+		const std::vector<uint8_t>& texture = pages[page];
+
+		float mod[4];
+
+		for (size_t i = 0; i < 4; i++)
+			mod[i] = ((v[0].c >> (i * 8)) & 0xFF) / 255.0f;
+
+		for (int32_t py = top; py < bottom; py++)
+		{
+			for (int32_t px = left; px < right; px++)
+			{
+				float cx = px + 0.5f - x0;
+				float cy = py + 0.5f - y0;
+				float a = (cx * wy - cy * wx) / det;
+				float b = (ux * cy - uy * cx) / det;
+
+				// Half open, so that quads which share an edge do not both cover it.
+				if (a < 0.0f || a >= 1.0f || b < 0.0f || b >= 1.0f)
+					continue;
+
+				float color[4] = { mod[0], mod[1], mod[2], mod[3] };
+
+				if (textured)
+				{
+					float s = v[0].s + a * (v[1].s - v[0].s) + b * (v[3].s - v[0].s);
+					float t = v[0].t + a * (v[1].t - v[0].t) + b * (v[3].t - v[0].t);
+
+					if (wrapped)
+					{
+						float ls = s - region.l - std::floor((s - region.l) / period.x()) * period.x();
+						float lt = t - region.t - std::floor((t - region.t) / period.y()) * period.y();
+
+						// The gap between repeats, where the shader discards the fragment.
+						if (ls >= region.r - region.l || lt >= region.b - region.t)
+							continue;
+
+						s = region.l + ls;
+						t = region.t + lt;
+					}
+
+					int32_t tx = std::min<int32_t>(std::max<int32_t>(static_cast<int32_t>(std::floor(s)), 0), atlaswidth - 1);
+					int32_t ty = std::min<int32_t>(std::max<int32_t>(static_cast<int32_t>(std::floor(t)), 0), atlasheight - 1);
+
+					const uint8_t* texel = &texture[(static_cast<size_t>(ty) * atlaswidth + tx) * 4];
+
+					if (t <= fontregion)
+					{
+						color[3] *= texel[2] / 255.0f;
+					}
+					else
+					{
+						color[0] *= texel[2] / 255.0f;
+						color[1] *= texel[1] / 255.0f;
+						color[2] *= texel[0] / 255.0f;
+						color[3] *= texel[3] / 255.0f;
+					}
+				}
+
+				uint8_t* pixel = &screen[(static_cast<size_t>(py) * screenwidth + px) * 4];
+				float alpha = std::min(std::max(color[3], 0.0f), 1.0f);
+
+				for (size_t i = 0; i < 3; i++)
+				{
+					float value = color[i] * 255.0f * alpha + pixel[i] * (1.0f - alpha);
+					pixel[i] = static_cast<uint8_t>(std::min(std::max(value + 0.5f, 0.0f), 255.0f));
+				}
+			}
+		}
+	}
+}
\ No newline at end of file
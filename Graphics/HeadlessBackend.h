@@ -0,0 +1,91 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "RenderBackend.h"
+
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace jrc
+{
+	// Keeps the quads of each frame in memory instead of drawing them, so that rendering can be
+	// measured and compared without a GPU. When rasterizing, the atlas pages are kept in memory
+	// as well and each frame is drawn in software the way the shader draws it.
+	class HeadlessBackend : public RenderBackend
+	{
+	public:
+		// A quad of the last frame, with the offset of its batch applied.
+		// Wrapped quads repeat the region every period pixels, the period is zero for all other quads.
+		struct DrawnQuad
+		{
+			Quad quad;
+			uint8_t page;
+			Quad::Offset region;
+			Point<int16_t> period;
+		};
+
+		HeadlessBackend(bool rasterize);
+
+		Error init(int16_t atlaswidth, int16_t atlasheight) override;
+		void reinit(int16_t screenwidth, int16_t screenheight, int16_t fontregion) override;
+		void close() override;
+
+		void addpage() override;
+		void upload(uint8_t page, int16_t x, int16_t y, int16_t width, int16_t height, const void* pixels) override;
+		void uploadglyph(uint8_t page, int16_t x, int16_t y, int16_t width, int16_t height, int32_t pitch, const void* pixels) override;
+
+		void storebatch(size_t id, const Quad* quads, size_t count) override;
+		void releasebatch(size_t id) override;
+
+		void begin(const Quad* quads, size_t count, size_t maxquads) override;
+		void drawquads(size_t first, size_t last, uint8_t page) override;
+		void drawwrapped(size_t first, size_t last, const Quad::Offset& region, Point<int16_t> period) override;
+		void drawbatch(size_t id, size_t first, size_t last, uint8_t page, Point<int16_t> offset) override;
+		void end() override;
+
+		// Return the quads of the last frame in the order in which they were drawn.
+		const std::vector<DrawnQuad>& get_quads() const;
+		// Write the quads of the last frame, one per line.
+		void dump(std::ostream& stream) const;
+		// Write the last frame as a png image. Returns false if frames are not rasterized or the file can not be written.
+		bool writepng(const std::string& filename) const;
+
+	private:
+		void record(const Quad& quad, uint8_t page, Point<int16_t> offset);
+		void rasterize(const DrawnQuad& drawnquad);
+
+		bool rasterizing;
+		int16_t atlaswidth;
+		int16_t atlasheight;
+		int16_t screenwidth;
+		int16_t screenheight;
+		int16_t fontregion;
+
+		// Pixels of each page in BGRA, only kept when rasterizing.
+		std::vector<std::vector<uint8_t>> pages;
+		std::unordered_map<size_t, std::vector<Quad>> batches;
+
+		const Quad* stream;
+		size_t streamcount;
+		std::vector<DrawnQuad> drawn;
+		// Pixels of the last frame in RGBA.
+		std::vector<uint8_t> screen;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#include "LayoutCache.h"
+
+#include <iterator>
+
+namespace jrc
+{
+	bool LayoutCache::Key::operator == (const Key& other) const
+	{
+		return font == other.font
+			&& alignment == other.alignment
+			&& maxwidth == other.maxwidth
+			&& formatted == other.formatted
+			&& line_adj == other.line_adj
+			&& text == other.text;
+	}
+
+	size_t LayoutCache::KeyHash::operator()(const Key& key) const
+	{
+		size_t params = key.font;
+		params = params * 4 + key.alignment;
+		params = params * 2 + key.formatted;
+		params = (params << 16) ^ static_cast<uint16_t>(key.maxwidth);
+		params = (params << 16) ^ static_cast<uint16_t>(key.line_adj);
+
+		size_t hash = std::hash<std::string>()(key.text);
+
+		return hash ^ (params + 0x9e3779b9 + (hash << 6) + (hash >> 2));
+	}
+
+	LayoutCache::LayoutCache()
+	{
+		capacity = 0;
+		stats = {};
+	}
+
+	void LayoutCache::set_capacity(size_t layouts)
+	{
+		capacity = layouts;
+		evict();
+	}
+
+	LayoutCache::Layout LayoutCache::find(const Key& key)
+	{
+		auto iter = index.find(key);
+
+		if (iter == index.end())
+		{
+			stats.misses++;
+			return nullptr;
+		}
+
+		const Layout& layout = iter->second->second;
+
+		// Building a layout allocates the lines, the advances and the words of each line.
+		stats.hits++;
+		stats.allocations += 2 + std::distance(layout->begin(), layout->end());
+
+		entries.splice(entries.begin(), entries, iter->second);
+
+		return layout;
+	}
+
+	void LayoutCache::insert(const Key& key, Layout layout)
+	{
+		if (!layout || capacity == 0 || index.count(key))
+			return;
+
+		entries.emplace_front(key, layout);
+		index.emplace(key, entries.begin());
+
+		evict();
+	}
+
+	LayoutCache::Stats LayoutCache::get_stats() const
+	{
+		return stats;
+	}
+
+	void LayoutCache::evict()
+	{
+		while (entries.size() > capacity)
+		{
+			stats.evictions++;
+
+			index.erase(entries.back().first);
+			entries.pop_back();
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "Text.h"
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace jrc
+{
+	// A bounded cache of text layouts, keyed by the text and every parameter which changes its layout.
+	// Layouts do not change once built, so texts with the same contents share one.
+	class LayoutCache
+	{
+	public:
+		using Layout = std::shared_ptr<const Text::Layout>;
+
+		struct Key
+		{
+			std::string text;
+			Text::Font font;
+			Text::Alignment alignment;
+			int16_t maxwidth;
+			bool formatted;
+			int16_t line_adj;
+
+			bool operator == (const Key& other) const;
+		};
+
+		struct Stats
+		{
+			size_t hits;
+			size_t misses;
+			size_t evictions;
+			// Vectors which did not have to be allocated because a layout was found.
+			size_t allocations;
+		};
+
+		LayoutCache();
+
+		// Set the maximum number of layouts kept. Zero disables the cache.
+		void set_capacity(size_t layouts);
+
+		// Return the layout for a key, or null if it is not cached.
+		Layout find(const Key& key);
+		// Store a layout, evicting the least recently used ones if needed.
+		void insert(const Key& key, Layout layout);
+
+		// Return the counters since the cache was created.
+		Stats get_stats() const;
+
+	private:
+		struct KeyHash
+		{
+			size_t operator()(const Key& key) const;
+		};
+
+		void evict();
+
+		using Entries = std::list<std::pair<Key, Layout>>;
+
+		Entries entries;
+		std::unordered_map<Key, Entries::iterator, KeyHash> index;
+		size_t capacity;
+		Stats stats;
+	};
+}
\ No newline at end of file
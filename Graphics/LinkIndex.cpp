@@ -0,0 +1,118 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#include "LinkIndex.h"
+
+#include "../Console.h"
+
+#include "nlnx/path.hpp"
+
+namespace jrc
+{
+	LinkIndex::Scope::Scope(const char* n) : name(n)
+	{
+		before = LinkIndex::get().get_stats();
+	}
+
+	LinkIndex::Scope::~Scope()
+	{
+		Stats after = LinkIndex::get().get_stats();
+
+		size_t links = after.links - before.links;
+		size_t saved = after.saved - before.saved;
+
+		if (links > 0)
+			Console::get().print(name, std::to_string(links) + " links, " + std::to_string(saved) + " lookups saved");
+	}
+
+	LinkIndex::LinkIndex()
+	{
+		stats = {};
+	}
+
+	nl::node LinkIndex::resolve(nl::node src)
+	{
+		std::string link = src["source"];
+		bool inlink = false;
+
+		if (link.empty())
+		{
+			link = src["_inlink"].get_string();
+			inlink = !link.empty();
+		}
+
+		if (link.empty())
+			link = src["_outlink"].get_string();
+
+		if (link.empty())
+			return src;
+
+		nl::node file = src.root();
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto& links = inlink ? files[file].inlinks : files[file].paths;
+		auto iter = links.find(link);
+
+		stats.links++;
+
+		if (iter != links.end())
+		{
+			stats.saved += iter->second.lookups;
+
+			return iter->second.target;
+		}
+
+		Link found = inlink ? find_inlink(file, link) : find_path(file, link);
+		stats.lookups += found.lookups;
+
+		links.emplace(link, found);
+
+		return found.target;
+	}
+
+	LinkIndex::Stats LinkIndex::get_stats() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		return stats;
+	}
+
+	LinkIndex::Link LinkIndex::find_path(nl::node file, const std::string& link) const
+	{
+		// The first part of the link is the name of the file.
+		return { file.resolve(link.substr(link.find('/') + 1)), 1 };
+	}
+
+	LinkIndex::Link LinkIndex::find_inlink(nl::node file, const std::string& link) const
+	{
+		// The link does not name the image it is in, so every image of the file is tried.
+		nl::path linkpath = link;
+		Link found = { nl::node(), 0 };
+
+		for (auto img = file.begin(); img != file.end(); ++img)
+		{
+			found.target = img.resolve(linkpath);
+			found.lookups++;
+
+			if (found.target.data_type() != nl::node::type::none)
+				break;
+		}
+
+		return found;
+	}
+}
\ No newline at end of file
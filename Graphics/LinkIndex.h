@@ -0,0 +1,86 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "../Template/Singleton.h"
+
+#include "nlnx/node.hpp"
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace jrc
+{
+	// Resolves the "source", "_inlink" and "_outlink" links of bitmap nodes.
+	// Each link is looked up only once per file, after that the bitmap it points to is remembered.
+	// Can be used from multiple threads.
+	class LinkIndex : public Singleton<LinkIndex>
+	{
+	public:
+		// Counters of how much path resolution the index avoided.
+		struct Stats
+		{
+			size_t links;
+			size_t lookups;
+			size_t saved;
+		};
+
+		// Counts the lookups saved while it exists and prints them when it goes out of scope.
+		class Scope
+		{
+		public:
+			Scope(const char* name);
+			~Scope();
+
+		private:
+			const char* name;
+			Stats before;
+		};
+
+		LinkIndex();
+
+		// Return the bitmap node which the given node links to, or the node itself if it has no link.
+		nl::node resolve(nl::node src);
+
+		// Return the counters since the index was created.
+		Stats get_stats() const;
+
+	private:
+		struct Link
+		{
+			nl::node target;
+			size_t lookups;
+		};
+
+		struct File
+		{
+			std::unordered_map<std::string, Link> paths;
+			std::unordered_map<std::string, Link> inlinks;
+		};
+
+		Link find_path(nl::node file, const std::string& link) const;
+		Link find_inlink(nl::node file, const std::string& link) const;
+
+		std::map<nl::node, File> files;
+		Stats stats;
+
+		mutable std::mutex mutex;
+	};
+}
\ No newline at end of file
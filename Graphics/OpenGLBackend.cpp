@@ -0,0 +1,293 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#include "OpenGLBackend.h"
+
+#include "../Constants.h"
+
+namespace jrc
+{
+	OpenGLBackend::OpenGLBackend()
+	{
+		atlaswidth = 0;
+		atlasheight = 0;
+		streambase = 0;
+	}
+
+	Error OpenGLBackend::init(int16_t aw, int16_t ah)
+	{
+		atlaswidth = aw;
+		atlasheight = ah;
+
+		if (glewInit())
+			return Error::GLEW;
+
+		GLint result = GL_FALSE;
+		GLuint vs = glCreateShader(GL_VERTEX_SHADER);
+
+		const char *vs_source =
+			"#version 120\n"
+			"attribute vec4 coord;"
+			"attribute vec4 color;"
+			"varying vec2 texpos;"
+			"varying vec4 colormod;"
+			"uniform vec2 screensize;"
+			"uniform int yoffset;"
+			"uniform vec2 offset;"
+
+			"void main(void) {"
+			"	float x = -1.0 + (coord.x + offset.x) * 2.0 / screensize.x;"
+			"	float y = 1.0 - (coord.y + offset.y + yoffset) * 2.0 / screensize.y;"
+			"   gl_Position = vec4(x, y, 0.0, 1.0);"
+			"	texpos = coord.zw;"
+			"	colormod = color;"
+			"}";
+
+		glShaderSource(vs, 1, &vs_source, NULL);
+		glCompileShader(vs);
+		glGetShaderiv(vs, GL_COMPILE_STATUS, &result);
+
+		if (!result)
+			return Error::VERTEX_SHADER;
+
+		GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
+
+		const char *fs_source =
+			"#version 120\n"
+			"varying vec2 texpos;"
+			"varying vec4 colormod;"
+			"uniform sampler2D texture;"
+			"uniform vec2 atlassize;"
+			"uniform int fontregion;"
+			"uniform vec4 wrapregion;"
+			"uniform vec2 wrapperiod;"
+
+			"void main(void) {"
+			"	vec2 pos = texpos;"
+			"	if (wrapperiod.x > 0.0) {"
+			"		vec2 local = mod(texpos - wrapregion.xy, wrapperiod);"
+			"		if (local.x >= wrapregion.z || local.y >= wrapregion.w) discard;"
+			"		pos = wrapregion.xy + local;"
+			"	}"
+			"	if (pos.y == 0) {"
+			"		gl_FragColor = colormod;"
+			"	} else if (pos.y <= fontregion) {"
+			"		gl_FragColor = vec4(1, 1, 1, texture2D(texture, pos / atlassize).r) * colormod;"
+			"	} else {"
+			"		gl_FragColor = texture2D(texture, pos / atlassize) * colormod;"
+			"	}"
+			"}";
+
+		glShaderSource(fs, 1, &fs_source, NULL);
+		glCompileShader(fs);
+		glGetShaderiv(fs, GL_COMPILE_STATUS, &result);
+
+		if (!result)
+			return Error::FRAGMENT_SHADER;
+
+		program = glCreateProgram();
+
+		glAttachShader(program, vs);
+		glAttachShader(program, fs);
+		glLinkProgram(program);
+		glGetProgramiv(program, GL_LINK_STATUS, &result);
+
+		if (!result)
+			return Error::SHADER_PROGRAM;
+
+		attribute_coord = glGetAttribLocation(program, "coord");
+		attribute_color = glGetAttribLocation(program, "color");
+		uniform_texture = glGetUniformLocation(program, "texture");
+		uniform_atlassize = glGetUniformLocation(program, "atlassize");
+		uniform_screensize = glGetUniformLocation(program, "screensize");
+		uniform_yoffset = glGetUniformLocation(program, "yoffset");
+		uniform_fontregion = glGetUniformLocation(program, "fontregion");
+		uniform_offset = glGetUniformLocation(program, "offset");
+		uniform_wrapregion = glGetUniformLocation(program, "wrapregion");
+		uniform_wrapperiod = glGetUniformLocation(program, "wrapperiod");
+
+		if (attribute_coord == -1 || attribute_color == -1 || uniform_texture == -1 || uniform_atlassize == -1 || uniform_yoffset == -1 || uniform_screensize == -1 || uniform_offset == -1 || uniform_wrapregion == -1 || uniform_wrapperiod == -1)
+			return Error::SHADER_VARS;
+
+		quadstream.init(sizeof(Quad));
+
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+		return Error::NONE;
+	}
+
+	void OpenGLBackend::reinit(int16_t screenwidth, int16_t screenheight, int16_t fontregion)
+	{
+		glUseProgram(program);
+
+		glUniform1i(uniform_yoffset, Constants::VIEWYOFFSET);
+		glUniform1i(uniform_fontregion, fontregion);
+		glUniform2f(uniform_wrapperiod, 0.0f, 0.0f);
+		glUniform2f(uniform_atlassize, atlaswidth, atlasheight);
+		glUniform2f(uniform_screensize, screenwidth, screenheight);
+
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+		for (auto texture : textures)
+		{
+			glBindTexture(GL_TEXTURE_2D, texture);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		}
+	}
+
+	void OpenGLBackend::close()
+	{
+		quadstream.close();
+
+		for (auto& iter : batches)
+			glDeleteBuffers(1, &iter.second);
+
+		batches.clear();
+	}
+
+	void OpenGLBackend::addpage()
+	{
+		GLuint texture;
+
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, atlaswidth, atlasheight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+		textures.push_back(texture);
+	}
+
+	void OpenGLBackend::upload(uint8_t page, int16_t x, int16_t y, int16_t width, int16_t height, const void* pixels)
+	{
+		glBindTexture(GL_TEXTURE_2D, textures[page]);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_BGRA, GL_UNSIGNED_BYTE, pixels);
+	}
+
+	void OpenGLBackend::uploadglyph(uint8_t page, int16_t x, int16_t y, int16_t width, int16_t height, int32_t pitch, const void* pixels)
+	{
+		glBindTexture(GL_TEXTURE_2D, textures[page]);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, pitch);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RED, GL_UNSIGNED_BYTE, pixels);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	}
+
+	void OpenGLBackend::storebatch(size_t id, const Quad* quads, size_t count)
+	{
+		GLuint& vbo = batches[id];
+
+		if (!vbo)
+			glGenBuffers(1, &vbo);
+
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		glBufferData(GL_ARRAY_BUFFER, count * sizeof(Quad), quads, GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	void OpenGLBackend::releasebatch(size_t id)
+	{
+		auto iter = batches.find(id);
+
+		if (iter == batches.end())
+			return;
+
+		glDeleteBuffers(1, &iter->second);
+		batches.erase(iter);
+	}
+
+	void OpenGLBackend::begin(const Quad* quads, size_t count, size_t maxquads)
+	{
+		glClearColor(1.0, 1.0, 1.0, 1.0);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		// Batches are drawn with the same index buffer, so it has to cover the largest one.
+		quadstream.reserve(maxquads);
+
+		streambase = quadstream.upload(quads, count);
+
+		glEnableVertexAttribArray(attribute_coord);
+		glEnableVertexAttribArray(attribute_color);
+	}
+
+	void OpenGLBackend::drawquads(size_t first, size_t last, uint8_t page)
+	{
+		if (first == last)
+			return;
+
+		quadstream.bind();
+
+		glUniform2f(uniform_offset, 0.0f, 0.0f);
+		drawelements(first, last, page, streambase);
+	}
+
+	void OpenGLBackend::drawwrapped(size_t first, size_t last, const Quad::Offset& region, Point<int16_t> period)
+	{
+		if (first == last)
+			return;
+
+		quadstream.bind();
+
+		glUniform2f(uniform_offset, 0.0f, 0.0f);
+		glUniform4f(uniform_wrapregion, region.l, region.t, region.r - region.l, region.b - region.t);
+		glUniform2f(uniform_wrapperiod, period.x(), period.y());
+		drawelements(first, last, region.page, streambase);
+
+		// A zero period turns wrapping off for the following draws.
+		glUniform2f(uniform_wrapperiod, 0.0f, 0.0f);
+	}
+
+	void OpenGLBackend::drawbatch(size_t id, size_t first, size_t last, uint8_t page, Point<int16_t> offset)
+	{
+		auto iter = batches.find(id);
+
+		if (iter == batches.end() || first == last)
+			return;
+
+		glBindBuffer(GL_ARRAY_BUFFER, iter->second);
+
+		glUniform2f(uniform_offset, offset.x(), offset.y());
+		drawelements(first, last, page, 0);
+	}
+
+	void OpenGLBackend::end()
+	{
+		glUniform2f(uniform_offset, 0.0f, 0.0f);
+
+		quadstream.finish();
+
+		glDisableVertexAttribArray(attribute_coord);
+		glDisableVertexAttribArray(attribute_color);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+
+	void OpenGLBackend::drawelements(size_t first, size_t last, uint8_t page, GLintptr base)
+	{
+		GLsizei icount = static_cast<GLsizei>((last - first) * 6);
+		const void* ioffset = reinterpret_cast<const void*>(first * 6 * sizeof(GLuint));
+
+		glVertexAttribPointer(attribute_coord, 4, GL_SHORT, GL_FALSE, sizeof(Quad::Vertex), (const void*)base);
+		glVertexAttribPointer(attribute_color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Quad::Vertex), (const void*)(base + 8));
+
+		glBindTexture(GL_TEXTURE_2D, textures[page]);
+		glDrawElements(GL_TRIANGLES, icount, GL_UNSIGNED_INT, ioffset);
+	}
+}
\ No newline at end of file
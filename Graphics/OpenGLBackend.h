@@ -0,0 +1,77 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "QuadStream.h"
+#include "RenderBackend.h"
+
+#include "GL/glew.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace jrc
+{
+	// Draws with OpenGL. Quads are streamed each frame, static batches are kept in their own vertex buffers.
+	class OpenGLBackend : public RenderBackend
+	{
+	public:
+		OpenGLBackend();
+
+		Error init(int16_t atlaswidth, int16_t atlasheight) override;
+		void reinit(int16_t screenwidth, int16_t screenheight, int16_t fontregion) override;
+		void close() override;
+
+		void addpage() override;
+		void upload(uint8_t page, int16_t x, int16_t y, int16_t width, int16_t height, const void* pixels) override;
+		void uploadglyph(uint8_t page, int16_t x, int16_t y, int16_t width, int16_t height, int32_t pitch, const void* pixels) override;
+
+		void storebatch(size_t id, const Quad* quads, size_t count) override;
+		void releasebatch(size_t id) override;
+
+		void begin(const Quad* quads, size_t count, size_t maxquads) override;
+		void drawquads(size_t first, size_t last, uint8_t page) override;
+		void drawwrapped(size_t first, size_t last, const Quad::Offset& region, Point<int16_t> period) override;
+		void drawbatch(size_t id, size_t first, size_t last, uint8_t page, Point<int16_t> offset) override;
+		void end() override;
+
+	private:
+		// Draw the quads from first to last of the bound vertex buffer, which starts at base.
+		void drawelements(size_t first, size_t last, uint8_t page, GLintptr base);
+
+		GLint program;
+		GLint attribute_coord;
+		GLint attribute_color;
+		GLint uniform_texture;
+		GLint uniform_atlassize;
+		GLint uniform_screensize;
+		GLint uniform_yoffset;
+		GLint uniform_fontregion;
+		GLint uniform_offset;
+		GLint uniform_wrapregion;
+		GLint uniform_wrapperiod;
+
+		int16_t atlaswidth;
+		int16_t atlasheight;
+
+		QuadStream quadstream;
+		GLintptr streambase;
+
+		std::vector<GLuint> textures;
+		std::unordered_map<size_t, GLuint> batches;
+	};
+}
\ No newline at end of file
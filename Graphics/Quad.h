@@ -0,0 +1,135 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "Color.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define JOURNEY_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace jrc
+{
+	// A textured rectangle as it is sent to the render backend, two triangles of four vertices.
+	struct Quad
+	{
+		// A rectangle of an atlas page.
+		struct Offset
+		{
+			int16_t l;
+			int16_t r;
+			int16_t t;
+			int16_t b;
+			uint8_t page;
+
+			Offset(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t p)
+			{
+				l = x;
+				r = x + w;
+				t = y;
+				b = y + h;
+				page = p;
+			}
+
+			Offset(int16_t x, int16_t y, int16_t w, int16_t h)
+				: Offset(x, y, w, h, 0) {}
+
+			Offset()
+			{
+				l = 0;
+				r = 0;
+				t = 0;
+				b = 0;
+				page = 0;
+			}
+		};
+
+		struct Vertex
+		{
+			int16_t x;
+			int16_t y;
+			int16_t s;
+			int16_t t;
+
+			// Normalized RGBA8, with red in the lowest byte.
+			uint32_t c;
+		};
+
+		static const size_t LENGTH = 4;
+		Vertex vertices[LENGTH];
+
+		Quad(int16_t l, int16_t r, int16_t t, int16_t b, const Offset& o, const Color& color, float rot)
+		{
+			uint32_t c = pack(color);
+
+			vertices[0] = { l, t, o.l, o.t, c };
+			vertices[1] = { l, b, o.l, o.b, c };
+			vertices[2] = { r, b, o.r, o.b, c };
+			vertices[3] = { r, t, o.r, o.t, c };
+
+			if (rot != 0.0f)
+			{
+				float cos = std::cos(rot);
+				float sin = std::sin(rot);
+				int16_t cx = (l + r) / 2;
+				int16_t cy = (t + b) / 2;
+
+				for (int i = 0; i < 4; i++)
+				{
+					int16_t vx = vertices[i].x - cx;
+					int16_t vy = vertices[i].y - cy;
+					float rx = std::roundf(vx * cos - vy * sin);
+					float ry = std::roundf(vx * sin + vy * cos);
+					vertices[i].x = static_cast<int16_t>(rx + cx);
+					vertices[i].y = static_cast<int16_t>(ry + cy);
+				}
+			}
+		}
+
+		// Convert the components to bytes, rounded to nearest with ties to even and clamped to [0, 255].
+		// Only this conversion uses SSE2, the vertices are built the same way on every target.
+		static uint32_t pack(const Color& color)
+		{
+#ifdef JOURNEY_USE_SSE2
+			__m128 scaled = _mm_mul_ps(_mm_setr_ps(color.r(), color.g(), color.b(), color.a()), _mm_set1_ps(255.0f));
+			__m128i words = _mm_cvtps_epi32(scaled);
+			words = _mm_packs_epi32(words, words);
+			words = _mm_packus_epi16(words, words);
+
+			return static_cast<uint32_t>(_mm_cvtsi128_si32(words));
+#else
+			uint32_t packed = 0;
+			const float* components = color.data();
+
+			for (size_t i = 0; i < Color::LENGTH; i++)
+			{
+				// Rounds like _mm_cvtps_epi32, so both paths give the same bytes.
+				float scaled = std::nearbyint(components[i] * 255.0f);
+				uint32_t byte = static_cast<uint32_t>(std::max(0.0f, std::min(scaled, 255.0f)));
+				packed |= byte << (i * 8);
+			}
+
+			return packed;
+#endif
+		}
+	};
+}
\ No newline at end of file
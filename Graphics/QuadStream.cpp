@@ -0,0 +1,195 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#include "QuadStream.h"
+
+#include <cstring>
+
+namespace jrc
+{
+	QuadStream::QuadStream()
+	{
+		vbo = 0;
+		ibo = 0;
+		quadsize = 0;
+		capacity = 0;
+		frame = 0;
+		persistent = false;
+		mapped = nullptr;
+
+		for (auto& fence : fences)
+			fence = nullptr;
+	}
+
+	void QuadStream::init(size_t qs)
+	{
+		destroy();
+
+		quadsize = qs;
+		capacity = MINQUADS;
+		persistent = GLEW_ARB_buffer_storage && GLEW_ARB_sync;
+
+		create();
+	}
+
+	void QuadStream::close()
+	{
+		destroy();
+	}
+
+	GLintptr QuadStream::upload(const void* quads, size_t count)
+	{
+		reserve(count);
+
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+
+		size_t bytes = count * quadsize;
+
+		if (persistent)
+		{
+			size_t region = frame % FRAMES;
+			size_t offset = region * capacity * quadsize;
+
+			wait(region);
+			std::memcpy(mapped + offset, quads, bytes);
+
+			return static_cast<GLintptr>(offset);
+		}
+		else
+		{
+			// Orphan the old storage, so that the driver does not wait for draws which still use it.
+			glBufferData(GL_ARRAY_BUFFER, capacity * quadsize, nullptr, GL_STREAM_DRAW);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, quads);
+
+			return 0;
+		}
+	}
+
+	void QuadStream::finish()
+	{
+		if (persistent)
+			fences[frame % FRAMES] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+		frame++;
+	}
+
+	void QuadStream::bind() const
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+	}
+
+	bool QuadStream::is_persistent() const
+	{
+		return persistent;
+	}
+
+	void QuadStream::reserve(size_t count)
+	{
+		if (count <= capacity)
+			return;
+
+		while (capacity < count)
+			capacity *= 2;
+
+		destroy();
+		create();
+	}
+
+	void QuadStream::create()
+	{
+		glGenBuffers(1, &vbo);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+		if (persistent)
+		{
+			GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			GLsizeiptr size = static_cast<GLsizeiptr>(capacity * quadsize * FRAMES);
+
+			glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags);
+			mapped = static_cast<uint8_t*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags));
+
+			if (!mapped)
+			{
+				glDeleteBuffers(1, &vbo);
+				glGenBuffers(1, &vbo);
+				glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+				persistent = false;
+			}
+		}
+
+		if (!persistent)
+			glBufferData(GL_ARRAY_BUFFER, capacity * quadsize, nullptr, GL_STREAM_DRAW);
+
+		// Two triangles per quad, sharing the first and third vertex.
+		std::vector<GLuint> indices(capacity * 6);
+
+		for (GLuint i = 0; i < capacity; i++)
+		{
+			GLuint first = i * 4;
+
+			indices[i * 6 + 0] = first;
+			indices[i * 6 + 1] = first + 1;
+			indices[i * 6 + 2] = first + 2;
+			indices[i * 6 + 3] = first;
+			indices[i * 6 + 4] = first + 2;
+			indices[i * 6 + 5] = first + 3;
+		}
+
+		glGenBuffers(1, &ibo);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+	}
+
+	void QuadStream::destroy()
+	{
+		for (size_t i = 0; i < FRAMES; i++)
+			wait(i);
+
+		if (mapped)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, vbo);
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+			mapped = nullptr;
+		}
+
+		if (vbo)
+			glDeleteBuffers(1, &vbo);
+
+		if (ibo)
+			glDeleteBuffers(1, &ibo);
+
+		vbo = 0;
+		ibo = 0;
+	}
+
+	void QuadStream::wait(size_t region)
+	{
+		GLsync& fence = fences[region];
+
+		if (!fence)
+			return;
+
+		while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+			continue;
+
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "GL/glew.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace jrc
+{
+	// Streams the vertices of each frame's quads to the GPU.
+	// When the driver supports persistent mapping, the vertex buffer is split into a ring of
+	// regions so that the CPU writes one frame while the GPU still reads the previous ones.
+	// Otherwise the buffer is orphaned before each upload.
+	// Quads are drawn as two triangles each, using a static index buffer.
+	class QuadStream
+	{
+	public:
+		QuadStream();
+
+		// Create the buffers for quads of the given size in bytes. Requires a current OpenGL context.
+		void init(size_t quadsize);
+		// Release the buffers.
+		void close();
+
+		// Copy the quads of this frame into the vertex buffer and bind both buffers.
+		// Returns the byte offset in the vertex buffer at which the quads start.
+		GLintptr upload(const void* quads, size_t count);
+		// Mark the region written by the last upload as in use until the GPU has finished drawing it.
+		void finish();
+		// Bind the vertex and index buffers again after drawing from other buffers.
+		void bind() const;
+		// Make sure that the buffers can hold the given number of quads.
+		void reserve(size_t count);
+
+		// Whether the vertex buffer is persistently mapped.
+		bool is_persistent() const;
+
+	private:
+		void create();
+		void destroy();
+		void wait(size_t region);
+
+		static const size_t FRAMES = 3;
+		static const size_t MINQUADS = 4096;
+
+		GLuint vbo;
+		GLuint ibo;
+		size_t quadsize;
+		size_t capacity;
+		size_t frame;
+		bool persistent;
+		uint8_t* mapped;
+		GLsync fences[FRAMES];
+	};
+}
\ No newline at end of file
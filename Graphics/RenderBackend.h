@@ -0,0 +1,66 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "Quad.h"
+
+#include "../Error.h"
+#include "../Template/Point.h"
+
+#include <cstdint>
+
+namespace jrc
+{
+	// Draws the quads built by GraphicsGL. The atlas bookkeeping and the quads themselves
+	// do not depend on the backend, only the textures, vertex buffers and draw calls do.
+	class RenderBackend
+	{
+	public:
+		virtual ~RenderBackend() {}
+
+		// Create the resources which do not depend on the screen. Atlas pages have the given size.
+		virtual Error init(int16_t atlaswidth, int16_t atlasheight) = 0;
+		// Set the size of the screen and the height of the font region at the top of every page.
+		virtual void reinit(int16_t screenwidth, int16_t screenheight, int16_t fontregion) = 0;
+		// Release all resources.
+		virtual void close() = 0;
+
+		// Add an empty atlas page. Pages are numbered in the order in which they are added.
+		virtual void addpage() = 0;
+		// Copy BGRA pixels into a page.
+		virtual void upload(uint8_t page, int16_t x, int16_t y, int16_t width, int16_t height, const void* pixels) = 0;
+		// Copy the coverage of a glyph, one byte per pixel in rows of pitch bytes, into the font region of a page.
+		virtual void uploadglyph(uint8_t page, int16_t x, int16_t y, int16_t width, int16_t height, int32_t pitch, const void* pixels) = 0;
+
+		// Keep the quads of a static batch, replacing those kept for the id before.
+		virtual void storebatch(size_t id, const Quad* quads, size_t count) = 0;
+		// Release the quads of a static batch.
+		virtual void releasebatch(size_t id) = 0;
+
+		// Clear the screen and take the quads of this frame. Batches of up to maxquads quads may be drawn.
+		virtual void begin(const Quad* quads, size_t count, size_t maxquads) = 0;
+		// Draw the quads of this frame from first to last with the texture of a page.
+		virtual void drawquads(size_t first, size_t last, uint8_t page) = 0;
+		// Draw the quads of this frame from first to last with a bitmap which repeats every period pixels.
+		// Texture coordinates wrap around inside the region, which is left empty where the period is larger than the bitmap.
+		virtual void drawwrapped(size_t first, size_t last, const Quad::Offset& region, Point<int16_t> period) = 0;
+		// Draw the quads of a batch from first to last with the texture of a page, shifted by the offset.
+		virtual void drawbatch(size_t id, size_t first, size_t last, uint8_t page, Point<int16_t> offset) = 0;
+		// Finish drawing the frame.
+		virtual void end() = 0;
+	};
+}
\ No newline at end of file
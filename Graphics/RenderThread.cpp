@@ -0,0 +1,428 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#include "RenderThread.h"
+
+#include <chrono>
+#include <cstring>
+
+namespace jrc
+{
+	RenderThread::RenderThread(std::unique_ptr<RenderBackend> b) : backend(std::move(b))
+	{
+		current = 0;
+		running = false;
+		stopping = false;
+		stats = {};
+
+		for (size_t i = LISTS - 1; i > 0; i--)
+			available.push_back(i);
+	}
+
+	RenderThread::~RenderThread()
+	{
+		stop();
+	}
+
+	void RenderThread::start(std::function<void(bool)> makecurrent, std::function<void()> present)
+	{
+		if (running)
+			return;
+
+		stopping = false;
+		running = true;
+
+		thread = std::thread(&RenderThread::run, this, makecurrent, present);
+	}
+
+	void RenderThread::stop()
+	{
+		if (!running)
+			return;
+
+		// Calls made since the last frame ended are drawn before the thread stops.
+		bool submitted = !lists[current].commands.empty();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			if (submitted)
+				pending.push_back(current);
+
+			stopping = true;
+		}
+
+		condition.notify_all();
+		thread.join();
+
+		running = false;
+
+		if (submitted)
+		{
+			current = available.back();
+			available.pop_back();
+		}
+	}
+
+	bool RenderThread::is_running() const
+	{
+		return running;
+	}
+
+	Error RenderThread::init(int16_t atlaswidth, int16_t atlasheight)
+	{
+		// Called by GraphicsGL::init while the creating thread still owns the context.
+		return backend->init(atlaswidth, atlasheight);
+	}
+
+	void RenderThread::reinit(int16_t screenwidth, int16_t screenheight, int16_t fontregion)
+	{
+		if (!running)
+			return backend->reinit(screenwidth, screenheight, fontregion);
+
+		Command command = {};
+		command.type = Command::REINIT;
+		command.values[0] = screenwidth;
+		command.values[1] = screenheight;
+		command.values[2] = fontregion;
+
+		push(command);
+	}
+
+	void RenderThread::close()
+	{
+		if (!running)
+			return backend->close();
+
+		Command command = {};
+		command.type = Command::CLOSE;
+
+		push(command);
+		stop();
+	}
+
+	void RenderThread::addpage()
+	{
+		if (!running)
+			return backend->addpage();
+
+		Command command = {};
+		command.type = Command::ADDPAGE;
+
+		push(command);
+	}
+
+	void RenderThread::upload(uint8_t page, int16_t x, int16_t y, int16_t width, int16_t height, const void* pixels)
+	{
+		if (!running)
+			return backend->upload(page, x, y, width, height, pixels);
+
+		size_t length = pixels ? static_cast<size_t>(width) * height * 4 : 0;
+
+		Command command = {};
+		command.type = Command::UPLOAD;
+		command.page = page;
+		command.values[0] = x;
+		command.values[1] = y;
+		command.values[2] = width;
+		command.values[3] = height;
+		command.data = store(pixels, length);
+		command.last = length;
+
+		push(command);
+	}
+
+	void RenderThread::uploadglyph(uint8_t page, int16_t x, int16_t y, int16_t width, int16_t height, int32_t pitch, const void* pixels)
+	{
+		if (!running)
+			return backend->uploadglyph(page, x, y, width, height, pitch, pixels);
+
+		// FreeType reuses the bitmap for the next glyph, so the rows are copied without their padding.
+		size_t length = pixels ? static_cast<size_t>(width) * height : 0;
+		size_t data = store(nullptr, length);
+		auto source = static_cast<const uint8_t*>(pixels);
+
+		for (int16_t row = 0; row < height && pixels; row++)
+			std::memcpy(&lists[current].bytes[data + row * width], source + row * pitch, width);
+
+		Command command = {};
+		command.type = Command::UPLOADGLYPH;
+		command.page = page;
+		command.values[0] = x;
+		command.values[1] = y;
+		command.values[2] = width;
+		command.values[3] = height;
+		command.data = data;
+		command.last = length;
+
+		push(command);
+	}
+
+	void RenderThread::storebatch(size_t id, const Quad* quads, size_t count)
+	{
+		if (!running)
+			return backend->storebatch(id, quads, count);
+
+		Command command = {};
+		command.type = Command::STOREBATCH;
+		command.id = id;
+		command.first = count;
+		command.data = store(quads, count * sizeof(Quad));
+
+		push(command);
+	}
+
+	void RenderThread::releasebatch(size_t id)
+	{
+		if (!running)
+			return backend->releasebatch(id);
+
+		Command command = {};
+		command.type = Command::RELEASEBATCH;
+		command.id = id;
+
+		push(command);
+	}
+
+	void RenderThread::begin(const Quad* quads, size_t count, size_t maxquads)
+	{
+		if (!running)
+			return backend->begin(quads, count, maxquads);
+
+		Command command = {};
+		command.type = Command::BEGIN;
+		command.first = count;
+		command.last = maxquads;
+		command.data = store(quads, count * sizeof(Quad));
+
+		push(command);
+	}
+
+	void RenderThread::drawquads(size_t first, size_t last, uint8_t page)
+	{
+		if (!running)
+			return backend->drawquads(first, last, page);
+
+		Command command = {};
+		command.type = Command::DRAWQUADS;
+		command.page = page;
+		command.first = first;
+		command.last = last;
+
+		push(command);
+	}
+
+	void RenderThread::drawwrapped(size_t first, size_t last, const Quad::Offset& region, Point<int16_t> period)
+	{
+		if (!running)
+			return backend->drawwrapped(first, last, region, period);
+
+		Command command = {};
+		command.type = Command::DRAWWRAPPED;
+		command.page = region.page;
+		command.values[0] = region.l;
+		command.values[1] = region.r;
+		command.values[2] = region.t;
+		command.values[3] = region.b;
+		command.values[4] = period.x();
+		command.values[5] = period.y();
+		command.first = first;
+		command.last = last;
+
+		push(command);
+	}
+
+	void RenderThread::drawbatch(size_t id, size_t first, size_t last, uint8_t page, Point<int16_t> offset)
+	{
+		if (!running)
+			return backend->drawbatch(id, first, last, page, offset);
+
+		Command command = {};
+		command.type = Command::DRAWBATCH;
+		command.page = page;
+		command.values[0] = offset.x();
+		command.values[1] = offset.y();
+		command.id = id;
+		command.first = first;
+		command.last = last;
+
+		push(command);
+	}
+
+	void RenderThread::end()
+	{
+		if (!running)
+			return backend->end();
+
+		Command command = {};
+		command.type = Command::END;
+
+		push(command);
+		submit();
+	}
+
+	RenderThread::Stats RenderThread::get_stats() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		return stats;
+	}
+
+	void RenderThread::push(const Command& command)
+	{
+		lists[current].commands.push_back(command);
+	}
+
+	size_t RenderThread::store(const void* data, size_t length)
+	{
+		std::vector<uint8_t>& bytes = lists[current].bytes;
+
+		// Quads are read in place, so every block starts aligned.
+		size_t offset = (bytes.size() + 7) & ~static_cast<size_t>(7);
+		bytes.resize(offset + length);
+
+		if (data && length > 0)
+			std::memcpy(&bytes[offset], data, length);
+
+		return offset;
+	}
+
+	void RenderThread::submit()
+	{
+		using clock = std::chrono::steady_clock;
+
+		std::unique_lock<std::mutex> lock(mutex);
+
+		pending.push_back(current);
+		stats.frames++;
+
+		condition.notify_all();
+
+		if (available.empty())
+		{
+			auto start = clock::now();
+
+			condition.wait(lock, [&]() { return !available.empty(); });
+
+			stats.waits++;
+			stats.waitmillis += std::chrono::duration<double, std::milli>(clock::now() - start).count();
+		}
+
+		current = available.back();
+		available.pop_back();
+	}
+
+	void RenderThread::execute(const Command& command, const DrawList& list)
+	{
+		const uint8_t* data = list.bytes.data() + command.data;
+		const Quad* quads = reinterpret_cast<const Quad*>(data);
+
+		switch (command.type)
+		{
+		case Command::REINIT:
+			backend->reinit(command.values[0], command.values[1], command.values[2]);
+			break;
+		case Command::ADDPAGE:
+			backend->addpage();
+			break;
+		case Command::UPLOAD:
+			backend->upload(command.page, command.values[0], command.values[1], command.values[2], command.values[3], command.last > 0 ? data : nullptr);
+			break;
+		case Command::UPLOADGLYPH:
+			backend->uploadglyph(command.page, command.values[0], command.values[1], command.values[2], command.values[3], command.values[2], command.last > 0 ? data : nullptr);
+			break;
+		case Command::STOREBATCH:
+			backend->storebatch(command.id, quads, command.first);
+			break;
+		case Command::RELEASEBATCH:
+			backend->releasebatch(command.id);
+			break;
+		case Command::BEGIN:
+			backend->begin(quads, command.first, command.last);
+			break;
+		case Command::DRAWQUADS:
+			backend->drawquads(command.first, command.last, command.page);
+			break;
+		case Command::DRAWWRAPPED:
+		{
+			Quad::Offset region;
+			region.l = command.values[0];
+			region.r = command.values[1];
+			region.t = command.values[2];
+			region.b = command.values[3];
+			region.page = command.page;
+
+			backend->drawwrapped(command.first, command.last, region, { command.values[4], command.values[5] });
+			break;
+		}
+		case Command::DRAWBATCH:
+			backend->drawbatch(command.id, command.first, command.last, command.page, { command.values[0], command.values[1] });
+			break;
+		case Command::END:
+			backend->end();
+			break;
+		case Command::CLOSE:
+			backend->close();
+			break;
+		}
+	}
+
+	void RenderThread::run(std::function<void(bool)> makecurrent, std::function<void()> present)
+	{
+		makecurrent(true);
+
+		while (true)
+		{
+			size_t id;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+
+				condition.wait(lock, [&]() { return stopping || !pending.empty(); });
+
+				if (pending.empty())
+					break;
+
+				id = pending.front();
+				pending.pop_front();
+			}
+
+			DrawList& list = lists[id];
+
+			for (auto& command : list.commands)
+			{
+				execute(command, list);
+
+				if (command.type == Command::END)
+					present();
+			}
+
+			list.commands.clear();
+			list.bytes.clear();
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				available.push_back(id);
+			}
+
+			condition.notify_all();
+		}
+
+		makecurrent(false);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,142 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "RenderBackend.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace jrc
+{
+	// Passes the calls of each frame to a backend on its own thread, which owns the OpenGL context.
+	// The game thread records the calls into a draw list, with copies of the quads and pixels,
+	// and hands the list over when the frame ends. Up to LISTS lists are in use at once, so the
+	// game thread only waits for the render thread when it is more than LISTS - 1 frames ahead.
+	// Calls made while the thread is not running go straight to the backend.
+	class RenderThread : public RenderBackend
+	{
+	public:
+		RenderThread(std::unique_ptr<RenderBackend> backend);
+		~RenderThread();
+
+		// Start drawing on a new thread. The context has to be released by the calling thread first.
+		// makecurrent is called on the render thread to acquire and release the context,
+		// present after each frame has been drawn.
+		void start(std::function<void(bool)> makecurrent, std::function<void()> present);
+		// Wait until all lists have been drawn and stop the thread. The context is released.
+		void stop();
+		// Whether the render thread is running.
+		bool is_running() const;
+
+		Error init(int16_t atlaswidth, int16_t atlasheight) override;
+		void reinit(int16_t screenwidth, int16_t screenheight, int16_t fontregion) override;
+		void close() override;
+
+		void addpage() override;
+		void upload(uint8_t page, int16_t x, int16_t y, int16_t width, int16_t height, const void* pixels) override;
+		void uploadglyph(uint8_t page, int16_t x, int16_t y, int16_t width, int16_t height, int32_t pitch, const void* pixels) override;
+
+		void storebatch(size_t id, const Quad* quads, size_t count) override;
+		void releasebatch(size_t id) override;
+
+		void begin(const Quad* quads, size_t count, size_t maxquads) override;
+		void drawquads(size_t first, size_t last, uint8_t page) override;
+		void drawwrapped(size_t first, size_t last, const Quad::Offset& region, Point<int16_t> period) override;
+		void drawbatch(size_t id, size_t first, size_t last, uint8_t page, Point<int16_t> offset) override;
+		void end() override;
+
+		// Counters of how often the game thread had to wait for a free list.
+		struct Stats
+		{
+			size_t frames;
+			size_t waits;
+			double waitmillis;
+		};
+
+		// Return the counters since the thread was created.
+		Stats get_stats() const;
+
+	private:
+		struct Command
+		{
+			enum Type : uint8_t
+			{
+				REINIT,
+				ADDPAGE,
+				UPLOAD,
+				UPLOADGLYPH,
+				STOREBATCH,
+				RELEASEBATCH,
+				BEGIN,
+				DRAWQUADS,
+				DRAWWRAPPED,
+				DRAWBATCH,
+				END,
+				CLOSE
+			};
+
+			Type type;
+			uint8_t page;
+			int16_t values[6];
+			size_t id;
+			size_t first;
+			size_t last;
+			// The pixels or quads of the command in the bytes of its list.
+			size_t data;
+		};
+
+		// The calls of one frame, with the data they need.
+		struct DrawList
+		{
+			std::vector<Command> commands;
+			std::vector<uint8_t> bytes;
+		};
+
+		static const size_t LISTS = 3;
+
+		// Add a command to the current list.
+		void push(const Command& command);
+		// Copy data into the current list and return its offset.
+		size_t store(const void* data, size_t length);
+		// Hand the current list to the render thread and take a free one.
+		void submit();
+		// Issue a command to the backend.
+		void execute(const Command& command, const DrawList& list);
+		void run(std::function<void(bool)> makecurrent, std::function<void()> present);
+
+		std::unique_ptr<RenderBackend> backend;
+
+		DrawList lists[LISTS];
+		size_t current;
+
+		std::thread thread;
+		bool running;
+		bool stopping;
+		Stats stats;
+
+		mutable std::mutex mutex;
+		std::condition_variable condition;
+		std::deque<size_t> pending;
+		std::vector<size_t> available;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#include "StaticBatch.h"
+#include "GraphicsGL.h"
+
+namespace jrc
+{
+	StaticBatch::StaticBatch()
+	{
+		id = 0;
+	}
+
+	void StaticBatch::begin()
+	{
+		GraphicsGL::get().setbatch(this);
+	}
+
+	void StaticBatch::end()
+	{
+		GraphicsGL::get().setbatch(nullptr);
+	}
+
+	void StaticBatch::draw(Point<int16_t> offset) const
+	{
+		GraphicsGL::get().drawbatch(*this, offset);
+	}
+
+	void StaticBatch::add(const nl::bitmap& bmp, const Rectangle<int16_t>& rect, const Color& color, float angle)
+	{
+		// Copies of a batch share the vertices uploaded for it until one of them is modified.
+		static size_t lastid = 0;
+
+		if (bmp.id() == 0)
+			return;
+
+		sprites.push_back({ bmp, rect, color, angle });
+		id = ++lastid;
+	}
+
+	bool StaticBatch::empty() const
+	{
+		return sprites.empty();
+	}
+
+	size_t StaticBatch::get_id() const
+	{
+		return id;
+	}
+
+	const std::vector<StaticBatch::Sprite>& StaticBatch::get_sprites() const
+	{
+		return sprites;
+	}
+}
\ No newline at end of file
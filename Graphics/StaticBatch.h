@@ -0,0 +1,64 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "Color.h"
+
+#include "../Template/Rectangle.h"
+
+#include "nlnx/bitmap.hpp"
+
+#include <vector>
+
+namespace jrc
+{
+	// Textures which never move, like the tiles of a map. Their vertices are kept
+	// on the GPU and drawn with an offset, so drawing them costs the same for any count.
+	class StaticBatch
+	{
+	public:
+		StaticBatch();
+
+		// Collect the textures drawn until end() is called into the batch, instead of drawing them.
+		void begin();
+		// Stop collecting textures.
+		void end();
+
+		// Draw all textures of the batch moved by the offset.
+		void draw(Point<int16_t> offset) const;
+
+		struct Sprite
+		{
+			nl::bitmap bitmap;
+			Rectangle<int16_t> rect;
+			Color color;
+			float angle;
+		};
+
+		// Add a bitmap to the batch.
+		void add(const nl::bitmap& bmp, const Rectangle<int16_t>& rect, const Color& color, float angle);
+
+		bool empty() const;
+		// Return an id which changes whenever the batch is modified.
+		size_t get_id() const;
+		const std::vector<Sprite>& get_sprites() const;
+
+	private:
+		size_t id;
+		std::vector<Sprite> sprites;
+	};
+}
\ No newline at end of file
@@ -20,7 +20,18 @@
 
 namespace jrc
 {
-	Text::Text(Font f, Alignment a, Color c, Background b, const std::string& t, uint16_t mw, bool fm, int16_t la) : font(f), alignment(a), color(c), background(b), maxwidth(mw), formatted(fm), line_adj(la)
+	namespace
+	{
+		// Shared by all texts which never had a layout.
+		const std::shared_ptr<const Text::Layout>& empty_layout()
+		{
+			static const std::shared_ptr<const Text::Layout> layout = std::make_shared<const Text::Layout>();
+
+			return layout;
+		}
+	}
+
+	Text::Text(Font f, Alignment a, Color c, Background b, const std::string& t, uint16_t mw, bool fm, int16_t la) : font(f), alignment(a), color(c), background(b), layout(empty_layout()), maxwidth(mw), formatted(fm), line_adj(la)
 	{
 		change_text(t);
 	}
@@ -63,12 +74,12 @@ namespace jrc
 
 	void Text::draw(const DrawArgument& args) const
 	{
-		GraphicsGL::get().drawtext(args, text, layout, font, color, background);
+		GraphicsGL::get().drawtext(args, text, *layout, font, color, background);
 	}
 
 	uint16_t Text::advance(size_t pos) const
 	{
-		return layout.advance(pos);
+		return layout->advance(pos);
 	}
 
 	bool Text::empty() const
@@ -83,22 +94,22 @@ namespace jrc
 
 	int16_t Text::width() const
 	{
-		return layout.width();
+		return layout->width();
 	}
 
 	int16_t Text::height() const
 	{
-		return layout.height();
+		return layout->height();
 	}
 
 	Point<int16_t> Text::dimensions() const
 	{
-		return layout.get_dimensions();
+		return layout->get_dimensions();
 	}
 
 	Point<int16_t> Text::endoffset() const
 	{
-		return layout.get_endoffset();
+		return layout->get_endoffset();
 	}
 
 	const std::string& Text::get_text() const
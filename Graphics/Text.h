@@ -20,6 +20,7 @@
 
 #include <cstdint>
 #include <map>
+#include <memory>
 #include <vector>
 
 namespace jrc
@@ -147,7 +148,7 @@ namespace jrc
 		Alignment alignment;
 		Color color;
 		Background background;
-		Layout layout;
+		std::shared_ptr<const Layout> layout;
 		uint16_t maxwidth;
 		bool formatted;
 		std::string text;
@@ -17,11 +17,10 @@
 //////////////////////////////////////////////////////////////////////////////
 #include "Texture.h"
 #include "GraphicsGL.h"
+#include "LinkIndex.h"
 
 #include "../Configuration.h"
 
-#include "nlnx/nx.hpp"
-
 namespace jrc
 {
 	Texture::Texture(nl::node src)
@@ -30,51 +29,7 @@ namespace jrc
 		{
 			origin = src["origin"];
 
-			std::string link = src["source"];
-
-			if (link != "")
-			{
-				nl::node srcfile = src;
-
-				while (srcfile != srcfile.root())
-					srcfile = srcfile.root();
-
-				src = srcfile.resolve(link.substr(link.find('/') + 1));
-			}
-			else
-			{
-				link = src["_inlink"];
-
-				if (link != "")
-				{
-					nl::node srcfile = src;
-
-					while (srcfile != srcfile.root())
-						srcfile = srcfile.root();
-
-					for (auto t = srcfile.begin(); t != srcfile.end(); ++t)
-					{
-						src = t.resolve(link);
-
-						if (src.data_type() != nl::node::type::none)
-							break;
-					}
-				}
-				else
-				{
-					link = src["_outlink"];
-
-					if (link != "")
-					{
-						nl::node srcfile = src;
-
-						while (srcfile != srcfile.root())
-							srcfile = srcfile.root();
-
-						src = srcfile.resolve(link.substr(link.find('/') + 1));
-					}
-				}
-			}
+			src = LinkIndex::get().resolve(src);
 
 			bitmap = src;
 			dimensions = Point<int16_t>(bitmap.width(), bitmap.height());
@@ -97,6 +52,19 @@ namespace jrc
 			.draw(bitmap, args.get_rectangle(origin, dimensions), args.get_color(), args.get_angle());
 	}
 
+	bool Texture::draw_wrapped(const DrawArgument& args, Point<int16_t> period, Point<int16_t> count) const
+	{
+		size_t id = bitmap.id();
+		if (id == 0)
+			return true;
+
+		if (args.get_angle() != 0.0f)
+			return false;
+
+		return GraphicsGL::get()
+			.drawwrapped(bitmap, args.get_rectangle(origin, dimensions), period, count, args.get_color());
+	}
+
 	void Texture::shift(Point<int16_t> amount)
 	{
 		origin -= amount;
@@ -32,6 +32,8 @@ namespace jrc
 		~Texture();
 
 		void draw(const DrawArgument& args) const;
+		// Draw count tiles, one every period pixels, as a single quad. Returns false if they have to be drawn one by one.
+		bool draw_wrapped(const DrawArgument& args, Point<int16_t> period, Point<int16_t> count) const;
 		void shift(Point<int16_t> amount);
 
 		bool is_valid() const;
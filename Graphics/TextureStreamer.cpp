@@ -0,0 +1,152 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#include "TextureStreamer.h"
+
+#include <algorithm>
+
+namespace jrc
+{
+	TextureStreamer::TextureStreamer(BitmapCache& c, BakedTextures& b) : cache(c), baked(b)
+	{
+		stopping = false;
+	}
+
+	TextureStreamer::~TextureStreamer()
+	{
+		stop();
+	}
+
+	void TextureStreamer::start(uint8_t threads)
+	{
+		stop();
+
+		if (threads == 0)
+		{
+			unsigned cores = std::thread::hardware_concurrency();
+			threads = static_cast<uint8_t>(std::min(std::max(cores, 2u) - 1, 255u));
+		}
+
+		stopping = false;
+
+		for (uint8_t i = 0; i < threads; i++)
+			workers.emplace_back(&TextureStreamer::work, this);
+	}
+
+	void TextureStreamer::stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			stopping = true;
+			pending.clear();
+			ready.clear();
+		}
+
+		condition.notify_all();
+
+		for (auto& worker : workers)
+			worker.join();
+
+		workers.clear();
+		requested.clear();
+	}
+
+	void TextureStreamer::request(const nl::bitmap& bmp)
+	{
+		if (workers.empty())
+			return;
+
+		if (!requested.insert(bmp.id()).second)
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			pending.push_back(bmp);
+		}
+
+		condition.notify_one();
+	}
+
+	bool TextureStreamer::poll(Decoded& decoded)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			if (ready.empty())
+				return false;
+
+			decoded = std::move(ready.front());
+			ready.pop_front();
+		}
+
+		requested.erase(decoded.bitmap.id());
+
+		return true;
+	}
+
+	size_t TextureStreamer::get_queued() const
+	{
+		return requested.size();
+	}
+
+	void TextureStreamer::work()
+	{
+		for (;;)
+		{
+			Decoded decoded;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+
+				condition.wait(lock, [&]() { return stopping || !pending.empty(); });
+
+				if (stopping)
+					return;
+
+				decoded.bitmap = pending.front();
+				pending.pop_front();
+			}
+
+			size_t id = decoded.bitmap.id();
+			decoded.pixels = cache.find(id);
+
+			if (!decoded.pixels)
+			{
+				decoded.pixels = baked.load(decoded.bitmap);
+
+				if (decoded.pixels)
+					cache.insert(id, decoded.pixels);
+			}
+
+			if (!decoded.pixels)
+			{
+				auto pixels = std::make_shared<std::vector<uint8_t>>(decoded.bitmap.length());
+				decoded.bitmap.decode(pixels->data());
+				decoded.pixels = pixels;
+
+				cache.insert(id, decoded.pixels);
+			}
+
+			std::lock_guard<std::mutex> lock(mutex);
+
+			if (!stopping)
+				ready.push_back(std::move(decoded));
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "BakedTextures.h"
+#include "BitmapCache.h"
+
+#include "nlnx/bitmap.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace jrc
+{
+	// Decodes bitmaps on worker threads so that they can be uploaded to the atlas later.
+	// Requests and polling must happen on the thread which owns the OpenGL context.
+	// Bitmaps found in the cache or the baked file are passed on without decoding them.
+	class TextureStreamer
+	{
+	public:
+		// A bitmap with its decompressed pixel data.
+		struct Decoded
+		{
+			nl::bitmap bitmap;
+			BitmapCache::Pixels pixels;
+		};
+
+		TextureStreamer(BitmapCache& cache, BakedTextures& baked);
+		~TextureStreamer();
+
+		// Start the worker threads. Zero means one less than the number of cores.
+		void start(uint8_t threads);
+		// Stop all workers and discard work that is still queued.
+		void stop();
+
+		// Queue a bitmap for decoding, unless it is already queued.
+		void request(const nl::bitmap& bmp);
+		// Take the next decoded bitmap. Returns false if none is ready.
+		bool poll(Decoded& decoded);
+
+		// Return the number of bitmaps which are waiting to be decoded or uploaded.
+		size_t get_queued() const;
+
+	private:
+		void work();
+
+		BitmapCache& cache;
+		BakedTextures& baked;
+		std::vector<std::thread> workers;
+		std::unordered_set<size_t> requested;
+
+		mutable std::mutex mutex;
+		std::condition_variable condition;
+		std::deque<nl::bitmap> pending;
+		std::deque<Decoded> ready;
+		bool stopping;
+	};
+}
\ No newline at end of file
@@ -24,11 +24,11 @@ namespace jrc
 
 		for (auto sub : src)
 		{
-			std::string name = sub.name();
+			nl::string_view name = sub.name_view();
 			if (sub.data_type() != nl::node::type::bitmap || name.empty())
 				continue;
 
-			char c = *name.begin();
+			char c = name.front();
 			if (c == '\\')
 			{
 				c = '/';
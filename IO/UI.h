@@ -24,6 +24,7 @@
 #include "Components/Textfield.h"
 #include "Components/ScrollingNotice.h"
 
+#include "../Graphics/LinkIndex.h"
 #include "../Template/Singleton.h"
 #include "../Template/Optional.h"
 
@@ -102,6 +103,8 @@ namespace jrc
 	{
 		if (auto iter = state->pre_add(T::TYPE, T::TOGGLED, T::FOCUSED))
 		{
+			LinkIndex::Scope scope(UIElement::get_name(T::TYPE));
+
 			(*iter).second = std::make_unique<T>(
 				std::forward<Args>(args)...
 				);
@@ -28,6 +28,21 @@ namespace jrc
 	UIElement::UIElement(Point<int16_t> p, Point<int16_t> d) : UIElement(p, d, true) {}
 	UIElement::UIElement() : UIElement({}, {}) {}
 
+	const char* UIElement::get_name(Type type)
+	{
+		static const char* names[NUM_TYPES] =
+		{
+			"None", "Start", "Login", "WorldSelect", "CharSelect", "LoginWait",
+			"CharCreation", "ClassCreation", "SoftKeyboard", "LoginNotice",
+			"LoginNoticeConfirm", "StatusMessenger", "StatusBar", "ChatBar",
+			"BuffList", "Notice", "NpcTalk", "Shop", "StatsInfo", "ItemInventory",
+			"EquipInventory", "SkillBook", "QuestLog", "WorldMap", "UserList",
+			"MiniMap", "Channel", "Chat", "ChatRank", "Joypad", "Event", "KeyConfig"
+		};
+
+		return type < NUM_TYPES ? names[type] : "Unknown";
+	}
+
 	void UIElement::draw(float alpha) const
 	{
 		draw_sprites(alpha);
@@ -72,6 +72,9 @@ namespace jrc
 			NUM_TYPES
 		};
 
+		// Return a readable name for a type of element.
+		static const char* get_name(Type type);
+
 		virtual ~UIElement() {}
 
 		virtual void draw(float inter) const;
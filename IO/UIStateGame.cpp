@@ -36,6 +36,7 @@
 #include "UITypes/UIKeyConfig.h"
 
 #include "../Gameplay/Stage.h"
+#include "../Graphics/LinkIndex.h"
 
 namespace jrc
 {
@@ -371,6 +372,8 @@ namespace jrc
 	{
 		if (auto iter = pre_add(T::TYPE, T::TOGGLED, T::FOCUSED))
 		{
+			LinkIndex::Scope scope(UIElement::get_name(T::TYPE));
+
 			(*iter).second = std::make_unique<T>(
 				std::forward<Args>(args)...
 				);
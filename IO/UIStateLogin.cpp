@@ -21,6 +21,7 @@
 #include "UITypes/UILogo.h"
 
 #include "../Configuration.h"
+#include "../Graphics/LinkIndex.h"
 
 namespace jrc
 {
@@ -137,6 +138,8 @@ namespace jrc
 	{
 		if (auto iter = pre_add(T::TYPE, T::TOGGLED, T::FOCUSED))
 		{
+			LinkIndex::Scope scope(UIElement::get_name(T::TYPE));
+
 			(*iter).second = std::make_unique<T>(
 				std::forward<Args>(args)...
 				);
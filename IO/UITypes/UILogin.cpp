@@ -25,6 +25,7 @@
 #include "../Audio/Audio.h"
 
 #include "../Net/Packets/LoginPackets.h"
+#include "../../Util/StartupTimeline.h"
 
 #include "nlnx/nx.hpp"
 
@@ -141,6 +142,8 @@ namespace jrc
 			passwordbg.draw(DrawArgument(position + Point<int16_t>(291, 295)));
 
 		checkbox[saveid].draw(DrawArgument(position + Point<int16_t>(291, 325)));
+
+		StartupTimeline::get().mark("login screen");
 	}
 
 	void UILogin::update()
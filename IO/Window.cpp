@@ -23,6 +23,8 @@
 #include "../Constants.h"
 #include "../Configuration.h"
 #include "../Graphics/GraphicsGL.h"
+#include "../Graphics/OpenGLBackend.h"
+#include "../Util/FrameProfiler.h"
 
 namespace jrc
 {
@@ -30,6 +32,7 @@ namespace jrc
 	{
 		context = nullptr;
 		glwnd = nullptr;
+		renderthread = nullptr;
 		opacity = 1.0f;
 		opcstep = 0.0f;
 		width = Constants::Constants::get().get_viewwidth();
@@ -46,8 +49,22 @@ namespace jrc
 		Console::get().print("glfw error: " + std::string(description) + " (" + std::to_string(no) + ")");
 	}
 
-	void key_callback(GLFWwindow*, int key, int, int action, int)
+	void key_callback(GLFWwindow*, int key, int, int action, int mods)
 	{
+		// Ctrl+F10 toggles the performance overlay, Ctrl+F9 saves the frame profile.
+		if (action == GLFW_PRESS && (mods & GLFW_MOD_CONTROL))
+		{
+			switch (key)
+			{
+			case GLFW_KEY_F10:
+				FrameProfiler::get().toggle_overlay();
+				return;
+			case GLFW_KEY_F9:
+				FrameProfiler::get().save();
+				return;
+			}
+		}
+
 		UI::get().send_key(key, action != GLFW_RELEASE);
 	}
 
@@ -109,14 +126,28 @@ namespace jrc
 		glfwWindowHint(GLFW_VISIBLE, GL_TRUE);
 		glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
 
-		if (Error error = GraphicsGL::get().init())
+		if (Setting<ThreadedRendering>::get().load())
+		{
+			auto backend = std::make_unique<RenderThread>(std::make_unique<OpenGLBackend>());
+			renderthread = backend.get();
+
+			if (Error error = GraphicsGL::get().init(std::move(backend)))
+				return error;
+		}
+		else if (Error error = GraphicsGL::get().init())
+		{
 			return error;
+		}
 
 		return initwindow();
 	}
 
 	Error Window::initwindow()
 	{
+		// The render thread has to finish with the old window and give back the context.
+		if (renderthread)
+			renderthread->stop();
+
 		if (glwnd)
 			glfwDestroyWindow(glwnd);
 
@@ -150,6 +181,15 @@ namespace jrc
 
 		GraphicsGL::get().reinit();
 
+		if (renderthread)
+		{
+			glfwMakeContextCurrent(nullptr);
+			renderthread->start(
+				[this](bool acquire) { glfwMakeContextCurrent(acquire ? glwnd : nullptr); },
+				[this]() { glfwSwapBuffers(glwnd); }
+			);
+		}
+
 		return Error::NONE;
 	}
 
@@ -216,8 +256,17 @@ namespace jrc
 
 	void Window::end() const
 	{
-		GraphicsGL::get().flush(opacity);
-		glfwSwapBuffers(glwnd);
+		{
+			FrameProfiler::Scope scope(FrameProfiler::FLUSH);
+			GraphicsGL::get().flush(opacity);
+		}
+
+		// With a render thread the buffers are swapped once the frame has been drawn.
+		if (!renderthread)
+		{
+			FrameProfiler::Scope scope(FrameProfiler::SWAP);
+			glfwSwapBuffers(glwnd);
+		}
 	}
 
 	void Window::fadeout(float step, std::function<void()> fadeproc)
@@ -237,4 +286,9 @@ namespace jrc
 
 		return text ? text : "";
 	}
+
+	const RenderThread* Window::get_renderthread() const
+	{
+		return renderthread;
+	}
 }
\ No newline at end of file
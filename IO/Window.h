@@ -17,6 +17,7 @@
 //////////////////////////////////////////////////////////////////////////////
 #pragma once
 #include "../Error.h"
+#include "../Graphics/RenderThread.h"
 #include "../Template/Singleton.h"
 
 #include <GL/glew.h>
@@ -46,11 +47,15 @@ namespace jrc
 		void setclipboard(const std::string& text) const;
 		std::string getclipboard() const;
 
+		// Return the render thread, or nullptr if drawing happens on the game thread.
+		const RenderThread* get_renderthread() const;
+
 	private:
 		void updateopc();
 
 		GLFWwindow* glwnd;
 		GLFWwindow* context;
+		RenderThread* renderthread;
 		bool fullscreen;
 		float opacity;
 		float opcstep;
@@ -22,58 +22,115 @@
 
 #include "Audio/Audio.h"
 #include "Character/Char.h"
+#include "Character/Look/Body.h"
 #include "Gameplay/Combat/DamageNumber.h"
 #include "Gameplay/Stage.h"
+#include "Gameplay/Maplemap/MapPrefetcher.h"
+#include "Graphics/AtlasPacker.h"
+#include "Graphics/BakedTextures.h"
+#include "Graphics/GraphicsGL.h"
+#include "Graphics/HeadlessBackend.h"
+#include "Graphics/LinkIndex.h"
 #include "IO/UI.h"
 #include "IO/Window.h"
 #include "Net/Session.h"
 #include "Util/NxFiles.h"
+#include "Util/FrameProfiler.h"
 #include "Util/HardwareInfo.h"
+#include "Util/StartupTimeline.h"
 
+#ifdef JOURNEY_ALLOC_COUNTER
+#include "Util/AllocationCounter.h"
+#endif
+
+#include "nlnx/bitmap.hpp"
+#include "nlnx/nx.hpp"
+#include "nlnx/path.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <set>
+#include <thread>
 
 namespace jrc
 {
 	Error init()
 	{
+		StartupTimeline& timeline = StartupTimeline::get();
+
 		if (Error error = Session::get().init())
 			return error;
 
+		timeline.mark("session");
+
 		if (Error error = NxFiles::init())
 			return error;
 
+		timeline.mark("nx files");
+
 		if (Error error = Window::get().init())
 			return error;
 
+		timeline.mark("window");
+
 		if (Error error = Sound::init())
 			return error;
 
 		if (Error error = Music::init())
 			return error;
 
+		timeline.mark("audio");
+
 		Char::init();
 		DamageNumber::init();
 		MapPortals::init();
+		timeline.mark("game data");
+
 		Stage::get().init();
 		UI::get().init();
+		timeline.mark("ui");
 
 		return Error::NONE;
 	}
 
 	void update()
 	{
-		Window::get().check_events();
-		Window::get().update();
-		Stage::get().update();
-		UI::get().update();
-		Session::get().read();
+		{
+			FrameProfiler::Scope scope(FrameProfiler::EVENTS);
+			Window::get().check_events();
+			Window::get().update();
+		}
+		{
+			FrameProfiler::Scope scope(FrameProfiler::STAGE_UPDATE);
+			Stage::get().update();
+		}
+		{
+			FrameProfiler::Scope scope(FrameProfiler::UI_UPDATE);
+			UI::get().update();
+		}
+		{
+			FrameProfiler::Scope scope(FrameProfiler::NETWORK);
+			Session::get().read();
+		}
 	}
 
 	void draw(float alpha)
 	{
 		Window::get().begin();
-		Stage::get().draw(alpha);
-		UI::get().draw(alpha);
+		{
+			FrameProfiler::Scope scope(FrameProfiler::STAGE_DRAW);
+			Stage::get().draw(alpha);
+		}
+		{
+			FrameProfiler::Scope scope(FrameProfiler::UI_DRAW);
+			UI::get().draw(alpha);
+		}
+		FrameProfiler::get().draw();
 		Window::get().end();
 	}
 
@@ -92,8 +149,14 @@ namespace jrc
 
 		int64_t period = 0;
 		int32_t samples = 0;
+		int32_t updates = 0;
+		int64_t shortest = INT64_MAX;
+		int64_t longest = 0;
+		LayoutCache::Stats layouts = {};
+		RenderThread::Stats rendering = {};
 
 		bool show_fps = Configuration::get().get_show_fps();
+		bool firstframe = true;
 
 		while (running())
 		{
@@ -103,30 +166,76 @@ namespace jrc
 			for (accumulator += elapsed; accumulator >= timestep; accumulator -= timestep)
 			{
 				update();
+				updates++;
 			}
 
 			// Draw the game. Interpolate to account for remaining time.
 			float alpha = static_cast<float>(accumulator) / timestep;
 			draw(alpha);
+			FrameProfiler::get().endframe();
+			if (firstframe)
+			{
+				StartupTimeline::get().mark("first frame");
+				StartupTimeline::get().report();
+
+				firstframe = false;
+			}
 
 			if (show_fps) {
 				if (samples < 100)
 				{
 					period += elapsed;
 					samples++;
+
+					shortest = std::min(shortest, elapsed);
+					longest = std::max(longest, elapsed);
 				}
 				else if (period)
 				{
 					int64_t fps = (samples * 1000000) / period;
 					std::cout << "FPS: " << fps << std::endl;
 
+					LayoutCache::Stats current = GraphicsGL::get().get_layoutstats();
+					size_t hits = current.hits - layouts.hits;
+					size_t lookups = hits + current.misses - layouts.misses;
+					int64_t saved = (current.allocations - layouts.allocations) * 1000000 / period;
+
+					if (lookups > 0)
+						std::cout << "Layouts: " << hits * 100 / lookups << "% of " << lookups << " cached, " << saved << " allocations saved per second" << std::endl;
+
+					layouts = current;
+
+					// A steady update rate needs frame times that stay close to the vsync interval.
+					std::cout << "Updates: " << static_cast<int64_t>(updates) * 1000000 / period << " per second, frames took "
+						<< shortest / 1000.0 << " to " << longest / 1000.0 << " ms" << std::endl;
+
+					if (const RenderThread* renderthread = Window::get().get_renderthread())
+					{
+						RenderThread::Stats stats = renderthread->get_stats();
+						size_t frames = stats.frames - rendering.frames;
+
+						std::cout << "Render thread: waited on " << stats.waits - rendering.waits << " of " << frames << " frames for "
+							<< stats.waitmillis - rendering.waitmillis << " ms" << std::endl;
+
+						rendering = stats;
+					}
+
 					period = 0;
 					samples = 0;
+					updates = 0;
+					shortest = INT64_MAX;
+					longest = 0;
 				}
 			}
 		}
 
+		FrameProfiler::get().save();
+
 		Sound::close();
+		GraphicsGL::get().close();
+
+		// Only written when nlnx was built with NLNX_STATS.
+		nl::nx::write_stats("NxStats.txt", 200);
 	}
 
 	void start()
@@ -152,10 +261,547 @@ namespace jrc
 			loop();
 		}
 	}
+
+	// Open the nx files for a command line mode which takes at least one argument.
+	// Prints the usage or the error and returns false if the mode cannot run.
+	bool init_mode(int argc, const char* usage)
+	{
+		if (argc < 3)
+		{
+			std::cout << "Usage: " << usage << std::endl;
+			return false;
+		}
+
+		if (Error error = NxFiles::init())
+		{
+			std::cout << "Error: " << error.get_message() << error.get_args() << std::endl;
+			return false;
+		}
+
+		return true;
+	}
+
+	// Decode the textures of the given maps into the baked texture file instead of starting the game.
+	int bake(int argc, char** argv)
+	{
+		if (!init_mode(argc, "--bake <mapid>..."))
+			return 1;
+
+		std::vector<nl::node> roots;
+
+		for (int i = 2; i < argc; i++)
+		{
+			for (auto& node : MapPrefetcher::collect(std::atoi(argv[i])))
+				roots.push_back(node);
+		}
+
+		std::string filename = Setting<BakedTextureFile>::get().load();
+		size_t count = BakedTextures::bake(filename, roots);
+
+		std::cout << "Baked " << count << " textures into " << filename << std::endl;
+
+		return count > 0 ? 0 : 1;
+	}
+
+	void collect_bitmaps(nl::node node, std::set<size_t>& ids, std::vector<nl::bitmap>& bitmaps)
+	{
+		if (node.data_type() == nl::node::type::bitmap)
+		{
+			nl::bitmap bmp = node;
+
+			if (ids.insert(bmp.id()).second)
+				bitmaps.push_back(bmp);
+		}
+
+		for (auto child : node)
+			collect_bitmaps(child, ids, bitmaps);
+	}
+
+	// Return the bitmaps of the maps given on the command line, each one only once.
+	std::vector<nl::bitmap> collect_maps(int argc, char** argv)
+	{
+		std::set<size_t> ids;
+		std::vector<nl::bitmap> bitmaps;
+
+		for (int i = 2; i < argc; i++)
+		{
+			for (auto& node : MapPrefetcher::collect(std::atoi(argv[i])))
+				collect_bitmaps(node, ids, bitmaps);
+		}
+
+		return bitmaps;
+	}
+
+	// Pack the bitmaps of the given maps with every atlas packer and print how well each did.
+	int packbench(int argc, char** argv)
+	{
+		if (!init_mode(argc, "--packbench <mapid>..."))
+			return 1;
+
+		std::vector<Point<int16_t>> sizes;
+
+		for (auto& bmp : collect_maps(argc, argv))
+			sizes.emplace_back(bmp.width(), bmp.height());
+
+		std::cout << "Packing " << sizes.size() << " bitmaps" << std::endl;
+
+		AtlasPacker::benchmark(sizes, 8192, 8192);
+
+		return 0;
+	}
+
+	// Decode the bitmaps of the given maps on one thread, then with decode_many on more and more threads,
+	// and print the throughput of each.
+	int decodebench(int argc, char** argv)
+	{
+		if (!init_mode(argc, "--decodebench <mapid>..."))
+			return 1;
+
+		std::vector<nl::bitmap> bitmaps = collect_maps(argc, argv);
+
+		size_t bytes = 0;
+
+		for (auto& bmp : bitmaps)
+			bytes += bmp.length();
+
+		std::vector<uint8_t> buffer(bytes);
+		std::vector<void*> outputs;
+		size_t offset = 0;
+
+		for (auto& bmp : bitmaps)
+		{
+			outputs.push_back(buffer.data() + offset);
+			offset += bmp.length();
+		}
+
+		std::cout << "Decoding " << bitmaps.size() << " bitmaps, " << bytes / (1024 * 1024) << " MB" << std::endl;
+
+		// The first pass reads the files into memory, so that every measured pass only decodes.
+		nl::decode_many(bitmaps, outputs);
+
+		using clock = std::chrono::steady_clock;
+
+		unsigned cores = std::max(std::thread::hardware_concurrency(), 1u);
+
+		for (unsigned threads = 1; ; threads = std::min(threads * 2, cores))
+		{
+			auto start = clock::now();
+
+			if (threads == 1)
+			{
+				for (size_t i = 0; i < bitmaps.size(); i++)
+					bitmaps[i].decode(outputs[i]);
+			}
+			else
+			{
+				nl::decode_many(bitmaps, outputs, threads);
+			}
+
+			double millis = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+			std::cout << threads << (threads == 1 ? " thread: " : " threads: ") << millis << " ms, "
+				<< bytes / (1024.0 * 1024.0) / (millis / 1000.0) << " MB/s" << std::endl;
+
+			if (threads == cores)
+				break;
+		}
+
+		return 0;
+	}
+
+	// Load the pixels of the bitmaps of the given maps from the nx files and from the baked file,
+	// and print the time each took. This is the part of loading a map which the baked file replaces.
+	int bakebench(int argc, char** argv)
+	{
+		if (!init_mode(argc, "--bakebench <mapid>..."))
+			return 1;
+
+		std::string filename = Setting<BakedTextureFile>::get().load();
+		BakedTextures baked;
+
+		if (filename.empty() || !baked.open(filename))
+		{
+			std::cout << "Could not open the baked file '" << filename << "', run --bake with the same maps first" << std::endl;
+			return 1;
+		}
+
+		std::vector<nl::bitmap> bitmaps = collect_maps(argc, argv);
+
+		using clock = std::chrono::steady_clock;
+
+		size_t decoded = 0;
+		auto start = clock::now();
+
+		for (auto& bmp : bitmaps)
+		{
+			auto pixels = std::make_shared<std::vector<uint8_t>>(bmp.length());
+
+			if (bmp.decode(pixels->data()))
+				decoded++;
+		}
+
+		double nxmillis = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+		size_t loaded = 0;
+		start = clock::now();
+
+		for (auto& bmp : bitmaps)
+		{
+			if (baked.load(bmp))
+				loaded++;
+		}
+
+		double bakedmillis = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+		std::cout << "Decoded " << decoded << " bitmaps from the nx files in " << nxmillis << " ms" << std::endl;
+		std::cout << "Loaded " << loaded << " of " << bitmaps.size() << " bitmaps from " << filename << " in " << bakedmillis << " ms" << std::endl;
+
+		baked.close();
+
+		return 0;
+	}
+
+#ifdef JOURNEY_ALLOC_COUNTER
+	// Add up the lengths of the names and strings of all nodes below the given one, read as copies or as views.
+	void read_names(nl::node node, bool views, size_t& length)
+	{
+		bool string = node.data_type() == nl::node::type::string;
+
+		if (views)
+			length += node.name_view().size() + (string ? node.get_string_view().size() : 0);
+		else
+			length += node.name().size() + (string ? node.get_string().size() : 0);
+
+		for (auto child : node)
+			read_names(child, views, length);
+	}
+
+	// Count the allocations made when reading the names of map nodes as copies and as views,
+	// and when building a character body and loading the given maps without a window.
+	int allocbench(int argc, char** argv)
+	{
+		if (!init_mode(argc, "--allocbench <mapid>..."))
+			return 1;
+
+		std::set<nl::node> roots;
+
+		for (int i = 2; i < argc; i++)
+		{
+			for (auto& node : MapPrefetcher::collect(std::atoi(argv[i])))
+				roots.insert(node);
+		}
+
+		for (bool views : { false, true })
+		{
+			size_t length = 0;
+			size_t before = AllocationCounter::get();
+
+			for (auto& root : roots)
+				read_names(root, views, length);
+
+			std::cout << (views ? "Names as views: " : "Names as strings: ") << AllocationCounter::get() - before
+				<< " allocations for " << length << " characters" << std::endl;
+		}
+
+		GraphicsGL& graphics = GraphicsGL::get();
+
+		if (Error error = graphics.init(std::make_unique<HeadlessBackend>(false)))
+		{
+			std::cout << "Error: " << error.get_message() << error.get_args() << std::endl;
+			return 1;
+		}
+
+		graphics.reinit();
+
+		// Unlike the names above, these counts can only be compared with a run of another build.
+		size_t before = AllocationCounter::get();
+
+		BodyDrawinfo drawinfo;
+		drawinfo.init();
+
+		std::cout << "Body drawinfo: " << AllocationCounter::get() - before << " allocations" << std::endl;
+
+		before = AllocationCounter::get();
+
+		Body body(0, drawinfo);
+
+		std::cout << "Body: " << AllocationCounter::get() - before << " allocations" << std::endl;
+
+		Char::init();
+		DamageNumber::init();
+		MapPortals::init();
+
+		Stage::get().init();
+
+		for (int i = 2; i < argc; i++)
+		{
+			int32_t mapid = std::atoi(argv[i]);
+
+			before = AllocationCounter::get();
+
+			Stage::get().load(mapid, 0);
+
+			std::cout << "Map " << mapid << ": " << AllocationCounter::get() - before << " allocations" << std::endl;
+		}
+
+		graphics.close();
+
+		return 0;
+	}
+#endif
+
+	void collect_links(nl::node node, std::vector<nl::node>& links)
+	{
+		if (node.data_type() == nl::node::type::bitmap && (node["source"] || node["_inlink"] || node["_outlink"]))
+			links.push_back(node);
+
+		for (auto child : node)
+			collect_links(child, links);
+	}
+
+	// Resolve the texture links of the given maps over and over with each way of resolving a path,
+	// and print the time each took per link.
+	int resolvebench(int argc, char** argv)
+	{
+		if (!init_mode(argc, "--resolvebench <mapid>..."))
+			return 1;
+
+		std::vector<nl::node> links;
+
+		for (int i = 2; i < argc; i++)
+		{
+			for (auto& node : MapPrefetcher::collect(std::atoi(argv[i])))
+				collect_links(node, links);
+		}
+
+		// Links to other images start with the name of their file, which is resolved from the root of the file.
+		std::vector<nl::node> files;
+		std::vector<std::string> strings;
+		std::vector<nl::path> paths;
+
+		for (auto& link : links)
+		{
+			std::string source = link["source"];
+
+			if (source.empty())
+				source = link["_outlink"].get_string();
+
+			if (source.empty())
+				continue;
+
+			files.push_back(link.root());
+			strings.push_back(source.substr(source.find('/') + 1));
+			paths.push_back(strings.back());
+		}
+
+		std::cout << links.size() << " links, " << strings.size() << " of them to other images" << std::endl;
+
+		if (links.empty())
+			return 0;
+
+		using clock = std::chrono::steady_clock;
+
+		const size_t REPEATS = 100;
+
+		size_t found = 0;
+
+		auto measure = [&](const char* name, size_t count, std::function<void()> pass)
+		{
+			found = 0;
+
+			auto start = clock::now();
+
+			for (size_t i = 0; i < REPEATS; i++)
+				pass();
+
+			double micros = std::chrono::duration<double, std::micro>(clock::now() - start).count();
+
+			std::cout << name << ": " << micros / REPEATS / 1000.0 << " ms per pass, "
+				<< micros / (REPEATS * std::max<size_t>(count, 1)) << " us per link, "
+				<< found / REPEATS << " found" << std::endl;
+		};
+
+		measure("resolve", strings.size(), [&]()
+		{
+			for (size_t i = 0; i < strings.size(); i++)
+				found += files[i].resolve(strings[i]) ? 1 : 0;
+		});
+
+		measure("resolve with a path", paths.size(), [&]()
+		{
+			for (size_t i = 0; i < paths.size(); i++)
+				found += files[i].resolve(paths[i]) ? 1 : 0;
+		});
+
+		measure("resolve_cached", strings.size(), [&]()
+		{
+			for (size_t i = 0; i < strings.size(); i++)
+				found += files[i].resolve_cached(strings[i]) ? 1 : 0;
+		});
+
+		// Also reads the link of each node and handles the links within the same image.
+		measure("link index", links.size(), [&]()
+		{
+			for (auto& link : links)
+				found += LinkIndex::get().resolve(link) ? 1 : 0;
+		});
+
+		return 0;
+	}
+
+	// Measure how fast quads are built and how many vertex bytes a frame of them streams.
+	int quadbench(int argc, char** argv)
+	{
+		size_t count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5000;
+
+		GraphicsGL::benchmark(count);
+
+		return 0;
+	}
+
+	// Draw a map without a window or GPU and print how long the stage takes to draw and flush.
+	// The last frame can be written as a png and its quads as text, to compare them with earlier runs.
+	int render(int argc, char** argv)
+	{
+		if (!init_mode(argc, "--render <mapid> [frames] [png file] [quads file]"))
+			return 1;
+
+		int32_t mapid = std::atoi(argv[2]);
+		size_t frames = argc > 3 ? std::max<size_t>(std::strtoul(argv[3], nullptr, 10), 1) : 100;
+		std::string pngfile = argc > 4 ? argv[4] : "";
+		std::string quadsfile = argc > 5 ? argv[5] : "";
+
+		auto backend = std::make_unique<HeadlessBackend>(!pngfile.empty());
+		HeadlessBackend* headless = backend.get();
+
+		GraphicsGL& graphics = GraphicsGL::get();
+
+		if (Error error = graphics.init(std::move(backend)))
+		{
+			std::cout << "Error: " << error.get_message() << error.get_args() << std::endl;
+			return 1;
+		}
+
+		graphics.reinit();
+
+		// The map starts its background music when it loads.
+		if (Error error = Sound::init())
+		{
+			std::cout << "Error: " << error.get_message() << error.get_args() << std::endl;
+			return 1;
+		}
+
+		if (Error error = Music::init())
+		{
+			std::cout << "Error: " << error.get_message() << error.get_args() << std::endl;
+			return 1;
+		}
+
+		Char::init();
+		DamageNumber::init();
+		MapPortals::init();
+
+		// A beginner with the default face and hair, so the player is drawn like in game.
+		CharEntry entry = {};
+		entry.stats.name = "Headless";
+		entry.stats.mapid = mapid;
+		entry.look.faceid = 20000;
+		entry.look.hairid = 30000;
+
+		Stage::get().init();
+		Stage::get().loadplayer(entry);
+		Stage::get().load(mapid, 0);
+
+		using clock = std::chrono::steady_clock;
+
+		double drawmillis = 0.0;
+		double flushmillis = 0.0;
+
+		for (size_t i = 0; i < frames; i++)
+		{
+			auto start = clock::now();
+
+			graphics.clearscene();
+			Stage::get().draw(1.0f);
+
+			auto drawn = clock::now();
+
+			graphics.flush(1.0f);
+
+			auto flushed = clock::now();
+
+			drawmillis += std::chrono::duration<double, std::milli>(drawn - start).count();
+			flushmillis += std::chrono::duration<double, std::milli>(flushed - drawn).count();
+		}
+
+		std::cout << "Map " << mapid << ": " << drawmillis / frames << " ms to draw and "
+			<< flushmillis / frames << " ms to flush per frame, "
+			<< headless->get_quads().size() << " quads in the last frame" << std::endl;
+
+		// Each wrapped quad replaces the quads of its visible tiles.
+		const GraphicsGL::DrawStats& drawstats = graphics.get_drawstats();
+
+		if (drawstats.wrappedquads > 0)
+			std::cout << "Backgrounds: " << drawstats.wrappedquads << " wrapped quads instead of "
+				<< drawstats.wrappedtiles << " tiles, " << headless->get_quads().size() - drawstats.wrappedquads + drawstats.wrappedtiles
+				<< " quads without wrapping" << std::endl;
+
+		if (!pngfile.empty() && !headless->writepng(pngfile))
+			std::cout << "Could not write " << pngfile << std::endl;
+
+		if (!quadsfile.empty())
+		{
+			std::ofstream file(quadsfile);
+			headless->dump(file);
+		}
+
+		graphics.close();
+
+		return 0;
+	}
+
+	// Measure the hit rate of the glyph cache in a busy chat channel, with the given font file or the normal font.
+	int glyphbench(int argc, char** argv)
+	{
+		std::string path = argc > 2 ? argv[2] : Setting<FontPathNormal>::get().load();
+
+		GlyphCache::benchmark(path);
+
+		return 0;
+	}
 }
 
-int main()
+int main(int argc, char** argv)
 {
+	if (argc > 1 && std::string(argv[1]) == "--bake")
+		return jrc::bake(argc, argv);
+
+	if (argc > 1 && std::string(argv[1]) == "--bakebench")
+		return jrc::bakebench(argc, argv);
+
+	if (argc > 1 && std::string(argv[1]) == "--packbench")
+		return jrc::packbench(argc, argv);
+
+	if (argc > 1 && std::string(argv[1]) == "--decodebench")
+		return jrc::decodebench(argc, argv);
+
+	if (argc > 1 && std::string(argv[1]) == "--resolvebench")
+		return jrc::resolvebench(argc, argv);
+
+	if (argc > 1 && std::string(argv[1]) == "--quadbench")
+		return jrc::quadbench(argc, argv);
+
+	if (argc > 1 && std::string(argv[1]) == "--render")
+		return jrc::render(argc, argv);
+
+	if (argc > 1 && std::string(argv[1]) == "--glyphbench")
+		return jrc::glyphbench(argc, argv);
+
+#ifdef JOURNEY_ALLOC_COUNTER
+	if (argc > 1 && std::string(argv[1]) == "--allocbench")
+		return jrc::allocbench(argc, argv);
+#endif
+
 	jrc::HardwareInfo();
 	jrc::start();
 	return 0;
@@ -34,11 +34,9 @@ namespace jrc
 		NxCheckPacket(uint64_t seed) : OutPacket(HASH_CHECK)
 		{
 			write_byte(NxFiles::NUM_FILES);
-			for (auto filename : NxFiles::filenames)
+			for (auto& hash : HashUtility::get_filehashes(seed))
 			{
-				write_string(
-					HashUtility::get_filehash(filename, seed)
-				);
+				write_string(hash);
 			}
 		}
 	};
@@ -0,0 +1,35 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#include "../Graphics/DrawStream.h"
+
+#include <iostream>
+
+// Play back a draw stream recorded by the client without a window and print the time spent per frame.
+// This only needs the headless backend, so it builds on any platform with CMake.
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		std::cout << "Usage: journey_replay <stream file> [png file]" << std::endl;
+		return 1;
+	}
+
+	jrc::DrawStreamPlayer::replay(argv[1], argc > 2 ? argv[2] : "");
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#include "AllocationCounter.h"
+
+#ifdef JOURNEY_ALLOC_COUNTER
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace jrc
+{
+	namespace
+	{
+		std::atomic<size_t> allocations(0);
+	}
+
+	namespace AllocationCounter
+	{
+		size_t get()
+		{
+			return allocations.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+// The array and nothrow forms of new and delete call these.
+void* operator new(size_t size)
+{
+	jrc::allocations.fetch_add(1, std::memory_order_relaxed);
+
+	for (;;)
+	{
+		if (void* memory = std::malloc(size > 0 ? size : 1))
+			return memory;
+
+		std::new_handler handler = std::get_new_handler();
+
+		if (!handler)
+			throw std::bad_alloc();
+
+		handler();
+	}
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	std::free(memory);
+}
+#endif
\ No newline at end of file
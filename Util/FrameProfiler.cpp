@@ -0,0 +1,345 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#include "FrameProfiler.h"
+
+#include "../Configuration.h"
+#include "../Console.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+namespace jrc
+{
+	namespace
+	{
+		std::string millis(int64_t micros)
+		{
+			char buffer[16];
+			std::snprintf(buffer, sizeof(buffer), "%.2f", micros / 1000.0);
+
+			return buffer;
+		}
+	}
+
+	const char* FrameProfiler::NAMES[NUM_PHASES] =
+	{
+		"events",
+		"stage_update",
+		"ui_update",
+		"network",
+		"stage_draw",
+		"ui_draw",
+		"flush",
+		"swap"
+	};
+
+	FrameProfiler::Scope::Scope(Phase p) : phase(p)
+	{
+		start = std::chrono::steady_clock::now();
+	}
+
+	FrameProfiler::Scope::~Scope()
+	{
+		auto elapsed = std::chrono::steady_clock::now() - start;
+		int64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+
+		FrameProfiler::get().add(phase, micros);
+	}
+
+	FrameProfiler::FrameProfiler()
+	{
+		std::fill(current, current + NUM_PHASES, 0);
+		std::fill(slowest, slowest + NUM_PHASES, 0);
+
+		framestart = clock::now();
+		frames = 0;
+		slowestframe = 0;
+		overlay = false;
+		fullwindow = false;
+	}
+
+	void FrameProfiler::add(Phase phase, int64_t micros)
+	{
+		session[phase].add(micros);
+		recent[phase].add(micros);
+		current[phase] += micros;
+	}
+
+	void FrameProfiler::endframe()
+	{
+		auto now = clock::now();
+		int64_t frame = std::chrono::duration_cast<std::chrono::microseconds>(now - framestart).count();
+		framestart = now;
+
+		frametimes.add(frame);
+		recentframes.add(frame);
+
+		if (frame > slowestframe)
+		{
+			slowestframe = frame;
+			std::copy(current, current + NUM_PHASES, slowest);
+		}
+
+		std::fill(current, current + NUM_PHASES, 0);
+
+		frames++;
+
+		if (overlay && !fullwindow && frames % PARTIAL == 0)
+			refresh();
+
+		if (frames < WINDOW)
+			return;
+
+		if (overlay)
+		{
+			refresh();
+			fullwindow = true;
+		}
+
+		for (auto& histogram : recent)
+			histogram.clear();
+
+		recentframes.clear();
+		slowestframe = 0;
+		frames = 0;
+	}
+
+	void FrameProfiler::toggle_overlay()
+	{
+		overlay = !overlay;
+		fullwindow = false;
+
+		// Show the frames of the current window right away.
+		if (overlay && frames > 0)
+			refresh();
+		else
+			lines.clear();
+	}
+
+	void FrameProfiler::refresh()
+	{
+		// The text changes at most every few frames, so the layouts stay cheap.
+		std::vector<std::string> texts;
+
+		auto describe = [](const char* name, const Histogram& histogram) {
+			return std::string(name)
+				+ "  p50 " + millis(histogram.percentile(0.50))
+				+ "  p95 " + millis(histogram.percentile(0.95))
+				+ "  p99 " + millis(histogram.percentile(0.99))
+				+ "  max " + millis(histogram.max()) + " ms";
+		};
+
+		texts.push_back(describe("frame", recentframes));
+
+		for (size_t i = 0; i < NUM_PHASES; i++)
+			texts.push_back(describe(NAMES[i], recent[i]));
+
+		// Name the two phases which took longest during the slowest frame.
+		size_t phases[NUM_PHASES];
+
+		for (size_t i = 0; i < NUM_PHASES; i++)
+			phases[i] = i;
+
+		std::partial_sort(phases, phases + 2, phases + NUM_PHASES, [&](size_t a, size_t b) {
+			return slowest[a] > slowest[b];
+		});
+
+		texts.push_back("slowest " + millis(slowestframe) + " ms: "
+			+ NAMES[phases[0]] + " " + millis(slowest[phases[0]]) + ", "
+			+ NAMES[phases[1]] + " " + millis(slowest[phases[1]]));
+
+		lines.resize(texts.size(), Text(Text::A11M, Text::LEFT, Text::WHITE));
+
+		int16_t width = 0;
+
+		for (size_t i = 0; i < texts.size(); i++)
+		{
+			lines[i].change_text(texts[i]);
+			width = std::max(width, lines[i].width());
+		}
+
+		int16_t height = static_cast<int16_t>(texts.size() * 14);
+		background = ColorBox(width + 8, height + 6, Geometry::BLACK, 0.6f);
+	}
+
+	void FrameProfiler::draw() const
+	{
+		if (!overlay || lines.empty())
+			return;
+
+		background.draw(Point<int16_t>(4, 4));
+
+		for (size_t i = 0; i < lines.size(); i++)
+			lines[i].draw(Point<int16_t>(8, static_cast<int16_t>(6 + i * 14)));
+	}
+
+	void FrameProfiler::save() const
+	{
+		std::string filename = Setting<FrameProfileFile>::get().load();
+
+		if (filename.empty())
+			return;
+
+		if (write_csv(filename + ".csv") && write_json(filename + ".json"))
+			Console::get().print("Saved frame profile to " + filename + ".csv and " + filename + ".json");
+	}
+
+	bool FrameProfiler::write_csv(const std::string& filename) const
+	{
+		std::ofstream file{ filename };
+
+		if (!file.good())
+			return false;
+
+		file << "phase,count,mean_us,p50_us,p95_us,p99_us,max_us" << std::endl;
+
+		auto row = [&](const char* name, const Histogram& histogram) {
+			file << name << ","
+				<< histogram.count() << ","
+				<< histogram.mean() << ","
+				<< histogram.percentile(0.50) << ","
+				<< histogram.percentile(0.95) << ","
+				<< histogram.percentile(0.99) << ","
+				<< histogram.max() << std::endl;
+		};
+
+		row("frame", frametimes);
+
+		for (size_t i = 0; i < NUM_PHASES; i++)
+			row(NAMES[i], session[i]);
+
+		return file.good();
+	}
+
+	bool FrameProfiler::write_json(const std::string& filename) const
+	{
+		std::ofstream file{ filename };
+
+		if (!file.good())
+			return false;
+
+		auto object = [&](const char* name, const Histogram& histogram) {
+			file << "\t\"" << name << "\": {"
+				<< "\"count\": " << histogram.count()
+				<< ", \"mean_us\": " << histogram.mean()
+				<< ", \"p50_us\": " << histogram.percentile(0.50)
+				<< ", \"p95_us\": " << histogram.percentile(0.95)
+				<< ", \"p99_us\": " << histogram.percentile(0.99)
+				<< ", \"max_us\": " << histogram.max() << "}";
+		};
+
+		file << "{" << std::endl;
+		object("frame", frametimes);
+
+		for (size_t i = 0; i < NUM_PHASES; i++)
+		{
+			file << "," << std::endl;
+			object(NAMES[i], session[i]);
+		}
+
+		file << std::endl << "}" << std::endl;
+
+		return file.good();
+	}
+
+	FrameProfiler::Histogram::Histogram()
+	{
+		clear();
+	}
+
+	void FrameProfiler::Histogram::add(int64_t micros)
+	{
+		micros = std::max<int64_t>(micros, 0);
+
+		buckets[index(micros)]++;
+		total++;
+		sum += micros;
+		maximum = std::max(maximum, micros);
+	}
+
+	void FrameProfiler::Histogram::clear()
+	{
+		std::fill(buckets, buckets + BUCKETS, 0);
+		total = 0;
+		sum = 0;
+		maximum = 0;
+	}
+
+	int64_t FrameProfiler::Histogram::percentile(double fraction) const
+	{
+		if (total == 0)
+			return 0;
+
+		size_t target = std::max<size_t>(static_cast<size_t>(std::ceil(fraction * total)), 1);
+		size_t counted = 0;
+
+		for (size_t i = 0; i < BUCKETS; i++)
+		{
+			counted += buckets[i];
+
+			if (counted >= target)
+				return std::min(upper(i), maximum);
+		}
+
+		return maximum;
+	}
+
+	int64_t FrameProfiler::Histogram::max() const
+	{
+		return maximum;
+	}
+
+	double FrameProfiler::Histogram::mean() const
+	{
+		return total > 0 ? static_cast<double>(sum) / total : 0.0;
+	}
+
+	size_t FrameProfiler::Histogram::count() const
+	{
+		return total;
+	}
+
+	size_t FrameProfiler::Histogram::index(int64_t micros)
+	{
+		if (micros < static_cast<int64_t>(SUBBUCKETS))
+			return static_cast<size_t>(micros);
+
+		// Values in [2^e, 2^(e+1)) are split into SUBBUCKETS buckets of width 2^(e-4).
+		size_t shift = 0;
+
+		while ((micros >> shift) >= static_cast<int64_t>(SUBBUCKETS * 2))
+			shift++;
+
+		size_t sub = static_cast<size_t>(micros >> shift) - SUBBUCKETS;
+
+		return std::min((shift + 1) * SUBBUCKETS + sub, BUCKETS - 1);
+	}
+
+	int64_t FrameProfiler::Histogram::upper(size_t index)
+	{
+		if (index < SUBBUCKETS)
+			return static_cast<int64_t>(index);
+
+		size_t shift = index / SUBBUCKETS - 1;
+		int64_t lower = static_cast<int64_t>(SUBBUCKETS + index % SUBBUCKETS) << shift;
+
+		return lower + (static_cast<int64_t>(1) << shift) - 1;
+	}
+}
\ No newline at end of file
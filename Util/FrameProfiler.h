@@ -0,0 +1,136 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "../Graphics/Geometry.h"
+#include "../Graphics/Text.h"
+#include "../Template/Singleton.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace jrc
+{
+	// Measures how long each phase of the game loop takes.
+	// Samples feed histograms for the whole session and for a short recent window,
+	// the recent window is shown in an overlay and the session can be saved as csv and json.
+	class FrameProfiler : public Singleton<FrameProfiler>
+	{
+	public:
+		enum Phase : uint8_t
+		{
+			EVENTS,
+			STAGE_UPDATE,
+			UI_UPDATE,
+			NETWORK,
+			STAGE_DRAW,
+			UI_DRAW,
+			FLUSH,
+			SWAP,
+			NUM_PHASES
+		};
+
+		// Times a phase from construction until destruction.
+		class Scope
+		{
+		public:
+			Scope(Phase phase);
+			~Scope();
+
+		private:
+			Phase phase;
+			std::chrono::steady_clock::time_point start;
+		};
+
+		FrameProfiler();
+
+		// Add the time spent in a phase to the current frame.
+		void add(Phase phase, int64_t micros);
+		// Close the current frame. Called once per iteration of the game loop.
+		void endframe();
+
+		void toggle_overlay();
+		// Draw the overlay if it is enabled.
+		void draw() const;
+
+		// Write the session histograms to the csv and json files named by the FrameProfileFile setting.
+		void save() const;
+		bool write_csv(const std::string& filename) const;
+		bool write_json(const std::string& filename) const;
+
+	private:
+		using clock = std::chrono::steady_clock;
+
+		// Log-linear histogram of microseconds with 16 buckets per power of two,
+		// so percentiles are within about 6% of the exact value.
+		class Histogram
+		{
+		public:
+			Histogram();
+
+			void add(int64_t micros);
+			void clear();
+
+			int64_t percentile(double fraction) const;
+			int64_t max() const;
+			double mean() const;
+			size_t count() const;
+
+		private:
+			static const size_t SUBBUCKETS = 16;
+			static const size_t BUCKETS = SUBBUCKETS * 24;
+
+			static size_t index(int64_t micros);
+			static int64_t upper(size_t index);
+
+			uint32_t buckets[BUCKETS];
+			size_t total;
+			int64_t sum;
+			int64_t maximum;
+		};
+
+		static const char* NAMES[NUM_PHASES];
+		// The number of frames shown in the overlay before it is refreshed.
+		static const size_t WINDOW = 120;
+		// Until the overlay has shown a whole window, it is refreshed after this many frames.
+		static const size_t PARTIAL = 10;
+
+		void refresh();
+
+		Histogram session[NUM_PHASES];
+		Histogram recent[NUM_PHASES];
+		Histogram frametimes;
+		Histogram recentframes;
+
+		// Time spent in each phase during the current frame.
+		int64_t current[NUM_PHASES];
+		clock::time_point framestart;
+		size_t frames;
+
+		// The phases of the slowest frame in the recent window, to tell which one caused a spike.
+		int64_t slowest[NUM_PHASES];
+		int64_t slowestframe;
+
+		bool overlay;
+		// Whether the overlay shows a whole window, rather than the frames of one so far.
+		bool fullwindow;
+		std::vector<Text> lines;
+		ColorBox background;
+	};
+}
\ No newline at end of file
@@ -19,9 +19,23 @@
 #include "HashUtility.h"
 
 #ifdef JOURNEY_USE_XXHASH
+#include "NxFiles.h"
+
+#include "../Console.h"
+
+#include "nlnx/file.hpp"
+
 #include <xxhash.h>
 
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <future>
+#include <sstream>
+#include <unordered_map>
 
 namespace jrc
 {
@@ -30,68 +44,186 @@ namespace jrc
 		// 128 MB.
 		const size_t CHUNK_SIZE = 134217728;
 
+		// File in which digests are kept between sessions.
+		const char* CACHE_FILENAME = "NxHashes";
+
+		// The values which decide if a cached digest can be reused.
+		struct CachedHash
+		{
+			uint64_t size;
+			int64_t mtime;
+			uint64_t seed;
+			std::string hash;
+		};
+
+		bool get_fileinfo(const char* filename, uint64_t& size, int64_t& mtime)
+		{
+#ifdef _WIN32
+			struct _stat64 info;
+			if (_stat64(filename, &info) != 0)
+				return false;
+#else
+			struct stat info;
+			if (stat(filename, &info) != 0)
+				return false;
+#endif
+			size = static_cast<uint64_t>(info.st_size);
+			mtime = static_cast<int64_t>(info.st_mtime);
+
+			return true;
+		}
+
+		std::unordered_map<std::string, CachedHash> load_cache()
+		{
+			std::unordered_map<std::string, CachedHash> cache;
+
+			std::ifstream file(CACHE_FILENAME);
+			std::string line;
+
+			// Each line contains: filename size mtime seed hash
+			while (std::getline(file, line))
+			{
+				std::istringstream stream(line);
+				std::string filename;
+				CachedHash entry;
+
+				if (stream >> filename >> entry.size >> entry.mtime >> entry.seed >> entry.hash)
+					cache[filename] = entry;
+			}
+
+			return cache;
+		}
+
+		void save_cache(const std::unordered_map<std::string, CachedHash>& cache)
+		{
+			std::ofstream file(CACHE_FILENAME);
+
+			for (auto& iter : cache)
+			{
+				const CachedHash& entry = iter.second;
+				file << iter.first << " " << entry.size << " " << entry.mtime << " " << entry.seed << " " << entry.hash << std::endl;
+			}
+		}
+
+		// The digest of a file, or the reason it could not be computed.
+		struct HashResult
+		{
+			std::string hash;
+			std::string error;
+		};
+
+		// Does not print, so that it can run on worker threads. Console is not thread-safe.
+		HashResult compute_filehash(const char* filename, uint64_t seed)
+		{
+			uint64_t result = 0;
+			std::string message;
+
+			try
+			{
+				// Hash the file through a memory mapping, in chunks.
+				nl::file file(filename);
+
+				auto data = reinterpret_cast<const char*>(file.base());
+				uint64_t size = file.size();
+
+				XXH64_state_t xxhstate;
+				XXH_errorcode error = XXH64_reset(&xxhstate, seed);
+
+				for (uint64_t offset = 0; offset < size && error == XXH_OK; offset += CHUNK_SIZE)
+				{
+					size_t length = static_cast<size_t>(std::min<uint64_t>(CHUNK_SIZE, size - offset));
+					error = XXH64_update(&xxhstate, data + offset, length);
+				}
+
+				if (error == XXH_OK)
+					result = XXH64_digest(&xxhstate);
+			}
+			catch (const std::exception& ex)
+			{
+				message = ex.what();
+			}
+
+			return { std::to_string(result), message };
+		}
+
 		std::string get_filehash(const char* filename, uint64_t seed)
 		{
-			// Open file stream.
-			std::ifstream file(filename);
+			HashResult result = compute_filehash(filename, seed);
+
+			if (!result.error.empty())
+				Console::get().print(__func__, result.error);
+
+			return result.hash;
+		}
+
+		std::vector<std::string> get_filehashes(uint64_t seed)
+		{
+			auto cache = load_cache();
+			auto start = std::chrono::steady_clock::now();
 
-			uint64_t result;
-			if (file.good())
+			std::vector<std::string> hashes(NxFiles::NUM_FILES);
+			std::vector<std::future<HashResult>> pending(NxFiles::NUM_FILES);
+			std::vector<CachedHash> infos(NxFiles::NUM_FILES);
+			uint64_t hashed = 0;
+
+			for (size_t i = 0; i < NxFiles::NUM_FILES; i++)
 			{
-				// Get size of file.
-				file.seekg(0, std::ios_base::end);
-				size_t end = file.tellg();
-				file.seekg(0, std::ios_base::beg);
+				const char* filename = NxFiles::filenames[i];
+				CachedHash& info = infos[i];
+				info.seed = seed;
+
+				if (!get_fileinfo(filename, info.size, info.mtime))
+				{
+					hashes[i] = "0";
+					continue;
+				}
 
-				if (end < CHUNK_SIZE)
+				auto iter = cache.find(filename);
+
+				if (iter != cache.end() && iter->second.size == info.size && iter->second.mtime == info.mtime && iter->second.seed == seed)
 				{
-					// File size is smaller than chunk size so process all at once.
-					char* buffer = new char[end];
-					file.read(buffer, end);
-					result = XXH64(buffer, end, seed);
-					delete[] buffer;
+					hashes[i] = iter->second.hash;
+					continue;
 				}
-				else
+
+				pending[i] = std::async(std::launch::async, compute_filehash, filename, seed);
+				hashed += info.size;
+			}
+
+			for (size_t i = 0; i < NxFiles::NUM_FILES; i++)
+			{
+				if (!pending[i].valid())
+					continue;
+
+				HashResult result = pending[i].get();
+				hashes[i] = result.hash;
+
+				// Errors are reported here, on the calling thread, and failed digests are not cached.
+				if (!result.error.empty())
 				{
-					// Read file in chunks instead.
-					char* buffer = new char[CHUNK_SIZE];
-					XXH64_state_t xxhstate;
-					XXH_errorcode error;
-
-					error = XXH64_reset(&xxhstate, seed);
-					size_t offset = 0;
-					while (offset < end && error == XXH_OK)
-					{
-						file.read(buffer, CHUNK_SIZE);
-						error = XXH64_update(&xxhstate, buffer, CHUNK_SIZE);
-						offset += CHUNK_SIZE;
-					}
-					size_t remaining = offset - end;
-					if (remaining > 0)
-					{
-						file.read(buffer, CHUNK_SIZE);
-						error = XXH64_update(&xxhstate, buffer, remaining);
-					}
-
-					if (error == XXH_OK)
-					{
-						result = XXH64_digest(&xxhstate);
-					}
-					else
-					{
-						result = 0;
-					}
-					delete[] buffer;
+					Console::get().print("get_filehash", std::string(NxFiles::filenames[i]) + ": " + result.error);
+					continue;
 				}
+
+				infos[i].hash = hashes[i];
+				cache[NxFiles::filenames[i]] = infos[i];
 			}
-			else
+
+			if (hashed > 0)
 			{
-				result = 0;
+				std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+				double gigabytes = hashed / 1073741824.0;
+
+				std::ostringstream report;
+				report << "Hashed " << gigabytes << " GB of game files in " << elapsed.count() << " s ("
+					<< gigabytes / std::max(elapsed.count(), 1e-9) << " GB/s)";
+				Console::get().print(report.str());
+
+				save_cache(cache);
 			}
 
-			file.close();
-			return std::to_string(result);
+			return hashes;
 		}
 	}
 }
-#endif
+#endif
\ No newline at end of file
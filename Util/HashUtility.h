@@ -21,6 +21,7 @@
 #ifdef JOURNEY_USE_XXHASH
 #include <cstdint>
 #include <string>
+#include <vector>
 
 namespace jrc
 {
@@ -29,6 +30,9 @@ namespace jrc
 	{
 		// Calculate file hash using the fast xxhash algorithm.
 		std::string get_filehash(const char* filename, uint64_t seed);
+		// Calculate the hashes of all game files in parallel, in the order of NxFiles::filenames.
+		// Hashes of files whose size and modification time did not change are read from a cache file.
+		std::vector<std::string> get_filehashes(uint64_t seed);
 	}
 }
 #endif
@@ -0,0 +1,131 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace jrc
+{
+	MappedFile::MappedFile()
+	{
+		base = nullptr;
+		length = 0;
+#ifdef _WIN32
+		handle = INVALID_HANDLE_VALUE;
+		mapping = nullptr;
+#else
+		handle = -1;
+#endif
+	}
+
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+	bool MappedFile::open(const std::string& filename)
+	{
+		close();
+
+#ifdef _WIN32
+		handle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+
+		LARGE_INTEGER filesize;
+
+		if (handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(handle, &filesize) || filesize.QuadPart == 0)
+		{
+			close();
+			return false;
+		}
+
+		length = static_cast<uint64_t>(filesize.QuadPart);
+		mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		if (mapping)
+			base = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+		handle = ::open(filename.c_str(), O_RDONLY);
+
+		struct stat info;
+
+		if (handle == -1 || fstat(handle, &info) == -1 || info.st_size == 0)
+		{
+			close();
+			return false;
+		}
+
+		length = static_cast<uint64_t>(info.st_size);
+		void* mapped = mmap(nullptr, static_cast<size_t>(length), PROT_READ, MAP_SHARED, handle, 0);
+
+		if (mapped != MAP_FAILED)
+			base = static_cast<const uint8_t*>(mapped);
+#endif
+
+		if (!base)
+		{
+			close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+#ifdef _WIN32
+		if (base)
+			UnmapViewOfFile(base);
+
+		if (mapping)
+			CloseHandle(mapping);
+
+		if (handle != INVALID_HANDLE_VALUE)
+			CloseHandle(handle);
+
+		handle = INVALID_HANDLE_VALUE;
+		mapping = nullptr;
+#else
+		if (base)
+			munmap(const_cast<uint8_t*>(base), static_cast<size_t>(length));
+
+		if (handle != -1)
+			::close(handle);
+
+		handle = -1;
+#endif
+		base = nullptr;
+		length = 0;
+	}
+
+	const uint8_t* MappedFile::data() const
+	{
+		return base;
+	}
+
+	uint64_t MappedFile::size() const
+	{
+		return length;
+	}
+}
\ No newline at end of file
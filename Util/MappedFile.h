@@ -0,0 +1,54 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace jrc
+{
+	// A read-only memory mapping of a whole file. The contents can be read from any thread while it is open.
+	class MappedFile
+	{
+	public:
+		MappedFile();
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator =(const MappedFile&) = delete;
+
+		// Map a file. Returns false if it does not exist, is empty or cannot be mapped.
+		bool open(const std::string& filename);
+		// Unmap the file.
+		void close();
+
+		// Return the start of the mapping, or null if no file is open.
+		const uint8_t* data() const;
+		// Return the size of the file in bytes.
+		uint64_t size() const;
+
+	private:
+		const uint8_t* base;
+		uint64_t length;
+#ifdef _WIN32
+		void* handle;
+		void* mapping;
+#else
+		int handle;
+#endif
+	};
+}
\ No newline at end of file
@@ -47,4 +47,95 @@ namespace jrc
 			return (mask & value) != 0;
 		}
 	}
+
+	namespace utf8
+	{
+		char32_t decode(const char* text, size_t length, size_t& pos)
+		{
+			const char32_t INVALID = 0xFFFD;
+
+			uint8_t first = static_cast<uint8_t>(text[pos]);
+			pos++;
+
+			if (first < 0x80)
+				return first;
+
+			size_t extra;
+			char32_t codepoint;
+
+			if (first >= 0xF8)
+			{
+				return INVALID;
+			}
+			else if (first >= 0xF0)
+			{
+				extra = 3;
+				codepoint = first & 0x07;
+			}
+			else if (first >= 0xE0)
+			{
+				extra = 2;
+				codepoint = first & 0x0F;
+			}
+			else if (first >= 0xC2)
+			{
+				extra = 1;
+				codepoint = first & 0x1F;
+			}
+			else
+			{
+				return INVALID;
+			}
+
+			if (pos + extra > length)
+				return INVALID;
+
+			for (size_t i = 0; i < extra; i++)
+			{
+				uint8_t next = static_cast<uint8_t>(text[pos + i]);
+
+				if ((next & 0xC0) != 0x80)
+					return INVALID;
+
+				codepoint = (codepoint << 6) | (next & 0x3F);
+			}
+
+			// Reject overlong encodings, surrogates and values past the last code point.
+			bool overlong = (extra == 2 && codepoint < 0x800) || (extra == 3 && codepoint < 0x10000);
+			bool surrogate = codepoint >= 0xD800 && codepoint <= 0xDFFF;
+
+			if (overlong || surrogate || codepoint > 0x10FFFF)
+				return INVALID;
+
+			pos += extra;
+
+			return codepoint;
+		}
+
+		void append(std::string& text, char32_t codepoint)
+		{
+			if (codepoint < 0x80)
+			{
+				text += static_cast<char>(codepoint);
+			}
+			else if (codepoint < 0x800)
+			{
+				text += static_cast<char>(0xC0 | (codepoint >> 6));
+				text += static_cast<char>(0x80 | (codepoint & 0x3F));
+			}
+			else if (codepoint < 0x10000)
+			{
+				text += static_cast<char>(0xE0 | (codepoint >> 12));
+				text += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+				text += static_cast<char>(0x80 | (codepoint & 0x3F));
+			}
+			else
+			{
+				text += static_cast<char>(0xF0 | (codepoint >> 18));
+				text += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+				text += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+				text += static_cast<char>(0x80 | (codepoint & 0x3F));
+			}
+		}
+	}
 }
\ No newline at end of file
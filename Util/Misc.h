@@ -18,6 +18,7 @@
 #pragma once
 #include "../Console.h"
 
+#include <cctype>
 #include <cstdint>
 #include <string>
 
@@ -40,6 +41,44 @@ namespace jrc
 			}
 		}
 
+		// Parse a decimal number without copying the string.
+		// Accepts the same input as std::stoi: leading whitespace, an optional sign
+		// and digits, ignoring anything after them. Unlike the overload above,
+		// failures return the default without printing to the console.
+		template<typename T>
+		inline T or_default(const char* str, size_t length, T def)
+		{
+			size_t i = 0;
+
+			while (i < length && std::isspace(static_cast<unsigned char>(str[i])))
+				i++;
+
+			bool negative = false;
+
+			if (i < length && (str[i] == '+' || str[i] == '-'))
+			{
+				negative = str[i] == '-';
+				i++;
+			}
+
+			const int64_t limit = INT32_MAX + static_cast<int64_t>(negative);
+			int64_t intval = 0;
+			size_t first = i;
+
+			for (; i < length && str[i] >= '0' && str[i] <= '9'; i++)
+			{
+				intval = intval * 10 + (str[i] - '0');
+
+				if (intval > limit)
+					return def;
+			}
+
+			if (i == first)
+				return def;
+
+			return static_cast<T>(negative ? -intval : intval);
+		}
+
 		template<typename T>
 		inline T or_zero(const std::string& str)
 		{
@@ -62,4 +101,14 @@ namespace jrc
 		// Check if a bit mask contains the specified value.
 		bool compare(int32_t mask, int32_t value);
 	}
+
+	namespace utf8
+	{
+		// Decode the code point which starts at pos and move pos past it.
+		// Malformed sequences decode to U+FFFD one byte at a time.
+		char32_t decode(const char* text, size_t length, size_t& pos);
+
+		// Append the encoding of a code point to a string.
+		void append(std::string& text, char32_t codepoint);
+	}
 }
\ No newline at end of file
@@ -34,9 +34,15 @@ namespace jrc
 				return{ Error::MISSING_FILE, filename };
 		}
 
+		// Files are opened on first access, which throws if one of them is corrupt.
+		bool postchaos = false;
+
 		try 
 		{
 			nl::nx::load_all();
+
+			constexpr const char* POSTCHAOS_BITMAP = "Login.img/WorldSelect/BtChannel/layer:bg";
+			postchaos = nl::nx::ui.resolve(POSTCHAOS_BITMAP).data_type() == nl::node::type::bitmap;
 		}
 		catch (const std::exception& ex)
 		{
@@ -44,8 +50,7 @@ namespace jrc
 			return{ Error::NLNX, message.c_str() };
 		}
 
-		constexpr const char* POSTCHAOS_BITMAP = "Login.img/WorldSelect/BtChannel/layer:bg";
-		if (nl::nx::ui.resolve(POSTCHAOS_BITMAP).data_type() != nl::node::type::bitmap)
+		if (!postchaos)
 			return Error::WRONG_UI_FILE;
 
 		return Error::NONE;
@@ -0,0 +1,167 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "../Template/Rectangle.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace jrc
+{
+	// Divides the map into square cells and remembers which entries overlap each of them,
+	// so that only the entries near an area have to be visited.
+	template<typename K>
+	class SpatialGrid
+	{
+	public:
+		SpatialGrid(int16_t cs)
+		{
+			cellsize = cs;
+		}
+
+		SpatialGrid()
+			: SpatialGrid(512) {}
+
+		void clear()
+		{
+			cells.clear();
+			entries.clear();
+		}
+
+		// Add an entry which covers the given area.
+		void insert(K key, const Rectangle<int16_t>& bounds)
+		{
+			erase(key);
+
+			entries[key] = bounds;
+
+			foreach_cell(bounds, [&](uint32_t cell) {
+				cells[cell].push_back(key);
+			});
+		}
+
+		// Remove an entry.
+		void erase(K key)
+		{
+			auto iter = entries.find(key);
+
+			if (iter == entries.end())
+				return;
+
+			remove(key, iter->second);
+			entries.erase(iter);
+		}
+
+		// Update the area of an entry. Only touches the cells if it moved into other ones.
+		void move(K key, const Rectangle<int16_t>& bounds)
+		{
+			auto iter = entries.find(key);
+
+			if (iter == entries.end())
+			{
+				insert(key, bounds);
+				return;
+			}
+
+			Rectangle<int16_t>& old = iter->second;
+
+			bool samecells = cellof(old.l()) == cellof(bounds.l()) && cellof(old.r()) == cellof(bounds.r())
+				&& cellof(old.t()) == cellof(bounds.t()) && cellof(old.b()) == cellof(bounds.b());
+
+			if (!samecells)
+			{
+				remove(key, old);
+
+				foreach_cell(bounds, [&](uint32_t cell) {
+					cells[cell].push_back(key);
+				});
+			}
+
+			old = bounds;
+		}
+
+		// Append the keys of all entries in the cells overlapping the area to the result, sorted and without duplicates.
+		void query(const Rectangle<int16_t>& area, std::vector<K>& result) const
+		{
+			size_t first = result.size();
+
+			foreach_cell(area, [&](uint32_t cell) {
+				auto iter = cells.find(cell);
+
+				if (iter != cells.end())
+					result.insert(result.end(), iter->second.begin(), iter->second.end());
+			});
+
+			std::sort(result.begin() + first, result.end());
+			result.erase(std::unique(result.begin() + first, result.end()), result.end());
+		}
+
+		size_t size() const
+		{
+			return entries.size();
+		}
+
+	private:
+		int16_t cellof(int16_t coord) const
+		{
+			// Round towards negative infinity, so that cell 0 does not cover both sides of the origin.
+			return static_cast<int16_t>(coord >= 0 ? coord / cellsize : (coord + 1) / cellsize - 1);
+		}
+
+		template<typename F>
+		void foreach_cell(const Rectangle<int16_t>& area, F&& f) const
+		{
+			int16_t left = cellof(std::min(area.l(), area.r()));
+			int16_t right = cellof(std::max(area.l(), area.r()));
+			int16_t top = cellof(std::min(area.t(), area.b()));
+			int16_t bottom = cellof(std::max(area.t(), area.b()));
+
+			for (int32_t y = top; y <= bottom; y++)
+				for (int32_t x = left; x <= right; x++)
+					f((static_cast<uint32_t>(y) << 16) | (static_cast<uint32_t>(x) & 0xFFFF));
+		}
+
+		void remove(K key, const Rectangle<int16_t>& bounds)
+		{
+			foreach_cell(bounds, [&](uint32_t cell) {
+				auto iter = cells.find(cell);
+
+				if (iter == cells.end())
+					return;
+
+				std::vector<K>& keys = iter->second;
+				auto kiter = std::find(keys.begin(), keys.end(), key);
+
+				if (kiter != keys.end())
+				{
+					*kiter = keys.back();
+					keys.pop_back();
+				}
+
+				if (keys.empty())
+					cells.erase(iter);
+			});
+		}
+
+		int16_t cellsize;
+		std::unordered_map<uint32_t, std::vector<K>> cells;
+		std::unordered_map<K, Rectangle<int16_t>> entries;
+	};
+}
\ No newline at end of file
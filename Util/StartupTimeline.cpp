@@ -0,0 +1,89 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#include "StartupTimeline.h"
+
+#include "nlnx/nx.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace jrc
+{
+	StartupTimeline::StartupTimeline()
+	{
+		begin = clock::now();
+		reported = false;
+	}
+
+	void StartupTimeline::mark(const char* name)
+	{
+		auto iter = std::find_if(marks.begin(), marks.end(), [name](const Mark& m) {
+			return m.name == name;
+		});
+
+		if (iter != marks.end())
+			return;
+
+		std::chrono::duration<double, std::milli> elapsed = clock::now() - begin;
+		marks.push_back({ name, elapsed.count() });
+	}
+
+	void StartupTimeline::report()
+	{
+		if (reported)
+			return;
+
+		reported = true;
+
+		std::cout << "Startup timeline:" << std::endl;
+
+		double last = 0.0;
+		for (auto& m : marks)
+		{
+			std::cout << "  " << m.name << ": " << m.milliseconds
+				<< " ms (+" << m.milliseconds - last << " ms)" << std::endl;
+			last = m.milliseconds;
+		}
+
+		auto files = nl::nx::open_infos();
+		for (auto& info : files)
+		{
+			if (info.opened)
+				std::cout << "  open " << info.name << ": " << info.milliseconds << " ms" << std::endl;
+			else if (!info.error.empty())
+				std::cout << "  failed to open " << info.name << ": " << info.error << std::endl;
+		}
+
+		// One line per run: build, then every mark and file open as name=milliseconds.
+		std::ofstream history{ HISTORY, std::ios::app };
+		if (!history.good())
+			return;
+
+		history << __DATE__ << " " << __TIME__;
+
+		for (auto& m : marks)
+			history << "," << m.name << "=" << m.milliseconds;
+
+		for (auto& info : files)
+			if (info.opened)
+				history << "," << info.name << "=" << info.milliseconds;
+
+		history << std::endl;
+	}
+}
\ No newline at end of file
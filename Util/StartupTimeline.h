@@ -0,0 +1,55 @@
+//////////////////////////////////////////////////////////////////////////////
+// This file is part of the Journey MMORPG client                           //
+// Copyright © 2015-2016 Daniel Allendorf                                   //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "../Template/Singleton.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace jrc
+{
+	// Records how long each startup phase took, measured from process start.
+	// The timeline is printed once the login screen is shown and appended to a history file.
+	class StartupTimeline : public Singleton<StartupTimeline>
+	{
+	public:
+		StartupTimeline();
+
+		// Record that a phase has finished. Only the first mark with a given name is kept.
+		void mark(const char* name);
+		// Print the timeline and nx open times, then append them to the history file.
+		// Only has an effect the first time it is called.
+		void report();
+
+	private:
+		using clock = std::chrono::steady_clock;
+
+		const char* HISTORY = "StartupTimes.csv";
+
+		struct Mark
+		{
+			std::string name;
+			double milliseconds;
+		};
+
+		clock::time_point begin;
+		std::vector<Mark> marks;
+		bool reported;
+	};
+}
\ No newline at end of file
@@ -17,7 +17,13 @@
 //////////////////////////////////////////////////////////////////////////////
 
 #include "bitmap.hpp"
+#include "stats.hpp"
 #include <lz4.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
 #include <vector>
 
 namespace nl {
@@ -32,17 +38,30 @@ namespace nl {
     bitmap::operator bool() const {
         return m_data ? true : false;
     }
-    std::vector<char> bitmap_buf;
+    thread_local std::vector<char> bitmap_buf;
     void const * bitmap::data() const {
         if (!m_data)
             return nullptr;
         auto const l = length();
         if (l + 0x20 > bitmap_buf.size())
             bitmap_buf.resize(l + 0x20);
-        ::LZ4_decompress_fast(4 + reinterpret_cast<char const *>(m_data),
-            bitmap_buf.data(), static_cast<int>(l));
+        decode(bitmap_buf.data());
         return bitmap_buf.data();
     }
+    bool bitmap::decode(void * out) const {
+        if (!m_data || !out)
+            return false;
+#ifdef NLNX_STATS
+        auto const start = std::chrono::steady_clock::now();
+#endif
+        ::LZ4_decompress_fast(4 + reinterpret_cast<char const *>(m_data),
+            reinterpret_cast<char *>(out), static_cast<int>(length()));
+#ifdef NLNX_STATS
+        std::chrono::duration<double, std::milli> const elapsed = std::chrono::steady_clock::now() - start;
+        stats::_decode(*this, elapsed.count());
+#endif
+        return true;
+    }
     uint16_t bitmap::width() const {
         return m_width;
     }
@@ -55,4 +74,25 @@ namespace nl {
     size_t bitmap::id() const {
         return reinterpret_cast<size_t>(m_data);
     }
+    void decode_many(std::vector<bitmap> const & bitmaps, std::vector<void *> const & outputs, unsigned threads) {
+        if (bitmaps.size() != outputs.size())
+            throw std::invalid_argument("decode_many needs one output per bitmap");
+        if (!threads)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<unsigned>(std::min<size_t>(threads, bitmaps.size()));
+        std::atomic<size_t> next{0};
+        auto work = [&] {
+            for (auto i = next++; i < bitmaps.size(); i = next++)
+                bitmaps[i].decode(outputs[i]);
+        };
+        if (threads <= 1)
+            return work();
+        std::vector<std::thread> pool;
+        pool.reserve(threads - 1);
+        for (auto i = 1u; i < threads; ++i)
+            pool.emplace_back(work);
+        work();
+        for (auto & t : pool)
+            t.join();
+    }
 }
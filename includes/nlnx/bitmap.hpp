@@ -20,6 +20,7 @@
 #include "nxfwd.hpp"
 #include <cstdint>
 #include <cstddef>
+#include <vector>
 
 namespace nl {
     class bitmap {
@@ -34,9 +35,14 @@ namespace nl {
         explicit operator bool() const;
         //This function decompresses the data on the fly
         //Do not free the pointer returned by this method
-        //Every time this function is called
-        //any previous pointers returned by this method become invalid
+        //The data is decompressed into a buffer owned by the calling thread
+        //Every time this function is called on the same thread
+        //any previous pointers returned by this method on that thread become invalid
         void const * data() const;
+        //Decompresses the data into a caller supplied buffer
+        //The buffer must be at least length() bytes large
+        //Safe to call from any thread, returns false for null bitmaps
+        bool decode(void *) const;
         uint16_t width() const;
         uint16_t height() const;
         uint32_t length() const;
@@ -49,4 +55,10 @@ namespace nl {
         uint16_t m_height = 0;
         friend node;
     };
+    //Decompresses a batch of bitmaps into caller supplied buffers
+    //The output for bitmaps[i] is written to outputs[i]
+    //which must be at least bitmaps[i].length() bytes large
+    //The work is split across the given number of threads
+    //If threads is zero, one thread per hardware core is used
+    void decode_many(std::vector<bitmap> const & bitmaps, std::vector<void *> const & outputs, unsigned threads = 0);
 }
@@ -40,6 +40,24 @@
 #include <stdexcept>
 
 namespace nl {
+    void _prefetch(void const * p, size_t length) {
+#ifdef _WIN32
+        //PrefetchVirtualMemory only exists on Windows 8 and later, so look it up at runtime
+        struct range_entry {
+            void * address;
+            size_t bytes;
+        };
+        typedef BOOL(WINAPI * prefetch_function)(HANDLE, ULONG_PTR, range_entry *, ULONG);
+        static auto const prefetch = reinterpret_cast<prefetch_function>(
+            ::GetProcAddress(::GetModuleHandleW(L"kernel32.dll"), "PrefetchVirtualMemory"));
+        if (!prefetch)
+            return;
+        range_entry range = {const_cast<void *>(p), length};
+        prefetch(::GetCurrentProcess(), 1, &range, 0);
+#else
+        ::madvise(const_cast<void *>(p), length, MADV_WILLNEED);
+#endif
+    }
     file::file(std::string name) {
         open(name);
     }
@@ -66,6 +84,13 @@ namespace nl {
 #  endif
         if (m_data->file_handle == INVALID_HANDLE_VALUE)
             throw std::runtime_error("Failed to open file " + name);
+        LARGE_INTEGER fsize;
+        if (!::GetFileSizeEx(m_data->file_handle, &fsize))
+            throw std::runtime_error("Failed to obtain file information of file " + name);
+        m_data->size = static_cast<uint64_t>(fsize.QuadPart);
+        FILETIME written;
+        if (::GetFileTime(m_data->file_handle, nullptr, nullptr, &written))
+            m_data->modified = (static_cast<uint64_t>(written.dwHighDateTime) << 32) | written.dwLowDateTime;
 #  if WINAPI_FAMILY == WINAPI_FAMILY_APP
         m_data->map = ::CreateFileMappingFromApp(m_data->file_handle, 0, PAGE_READONLY, 0, nullptr);
 #  else
@@ -88,7 +113,8 @@ namespace nl {
         if (::fstat(m_data->file_handle, &finfo) == -1)
             throw std::runtime_error("Failed to obtain file information of file " + name);
         m_data->size = finfo.st_size;
-        m_data->base = ::mmap(nullptr, m_data->size, PROT_READ, MAP_SHARED, m_data->file_handle, 0);
+        m_data->modified = static_cast<uint64_t>(finfo.st_mtime);
+        m_data->base = ::mmap(nullptr, static_cast<size_t>(m_data->size), PROT_READ, MAP_SHARED, m_data->file_handle, 0);
         if (reinterpret_cast<intptr_t>(m_data->base) == -1)
             throw std::runtime_error("Failed to create memory mapping of file " + name);
 #endif
@@ -107,7 +133,7 @@ namespace nl {
         ::CloseHandle(m_data->map);
         ::CloseHandle(m_data->file_handle);
 #else
-        ::munmap(const_cast<void *>(m_data->base), m_data->size);
+        ::munmap(const_cast<void *>(m_data->base), static_cast<size_t>(m_data->size));
         ::close(m_data->file_handle);
 #endif
         delete m_data;
@@ -132,7 +158,32 @@ namespace nl {
         return m_data->header->node_count;
     }
     std::string file::get_string(uint32_t i) const {
+        return static_cast<std::string>(get_string_view(i));
+    }
+    string_view file::get_string_view(uint32_t i) const {
         auto const s = reinterpret_cast<char const *>(m_data->base) + m_data->string_table[i];
         return {s + 2, *reinterpret_cast<uint16_t const *>(s)};
     }
+    void const * file::base() const {
+        return m_data->base;
+    }
+    uint64_t file::size() const {
+        return m_data->size;
+    }
+    uint64_t file::digest() const {
+        //FNV-1a over the size, the last write time and the header
+        //The time catches files which were patched in place without changing their size
+        auto hash = 0xcbf29ce484222325ull;
+        auto mix = [&hash](void const * p, size_t n) {
+            auto const bytes = reinterpret_cast<uint8_t const *>(p);
+            for (auto i = 0u; i < n; ++i) {
+                hash ^= bytes[i];
+                hash *= 0x100000001b3ull;
+            }
+        };
+        mix(&m_data->size, sizeof(m_data->size));
+        mix(&m_data->modified, sizeof(m_data->modified));
+        mix(m_data->header, sizeof(header));
+        return hash;
+    }
 }
@@ -18,6 +18,7 @@
 
 #pragma once
 #include "nxfwd.hpp"
+#include "string_view.hpp"
 #include <cstdint>
 #include <string>
 
@@ -65,6 +66,15 @@ namespace nl {
         uint32_t node_count() const;
         //Returns the string with a given id number
         std::string get_string(uint32_t) const;
+        //Returns a view of the string with a given id number, without copying it
+        string_view get_string_view(uint32_t) const;
+        //Returns the start of the memory mapping of the file
+        void const * base() const;
+        //Returns the size of the file in bytes
+        uint64_t size() const;
+        //Returns a fingerprint of the file built from its size, last write time and header
+        //It changes whenever the file is rebuilt or patched in place
+        uint64_t digest() const;
     private:
         data * m_data = nullptr;
         friend node;
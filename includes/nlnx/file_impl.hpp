@@ -34,6 +34,8 @@ namespace nl {
         uint64_t const audio_offset;
     };
 #pragma pack(pop)
+    //Hints to the operating system that the given range of a mapped file will be read soon
+    void _prefetch(void const *, size_t);
     struct _file_data {
         void const * base = nullptr;
         node::data const * node_table = nullptr;
@@ -41,12 +43,14 @@ namespace nl {
         uint64_t const * bitmap_table = nullptr;
         uint64_t const * audio_table = nullptr;
         file::header const * header = nullptr;
+        uint64_t size = 0;
+        //Last write time, in the units of the platform
+        uint64_t modified = 0;
 #ifdef _WIN32
         void * file_handle = nullptr;
         void * map = nullptr;
 #else
         int file_handle = 0;
-        size_t size = 0;
 #endif
     };
 }
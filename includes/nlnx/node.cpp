@@ -20,10 +20,17 @@
 #include "file_impl.hpp"
 #include "bitmap.hpp"
 #include "audio.hpp"
+#include "path.hpp"
+#include "stats.hpp"
+#include <algorithm>
 #include <cstring>
+#include <functional>
+#include <list>
+#include <mutex>
 #include <stdexcept>
+#include <unordered_map>
+#include <utility>
 #include <vector>
-#include <sstream>
 
 namespace nl {
     node::node(node const & o) :
@@ -72,22 +79,22 @@ namespace nl {
         return n.get_string() + s;
     }
     node node::operator[](unsigned int n) const {
-        return operator[](std::to_string(n));
+        return get_numeric_child(n);
     }
     node node::operator[](signed int n) const {
-        return operator[](std::to_string(n));
+        return n < 0 ? operator[](std::to_string(n)) : get_numeric_child(static_cast<uint64_t>(n));
     }
     node node::operator[](unsigned long n) const {
-        return operator[](std::to_string(n));
+        return get_numeric_child(n);
     }
     node node::operator[](signed long n) const {
-        return operator[](std::to_string(n));
+        return n < 0 ? operator[](std::to_string(n)) : get_numeric_child(static_cast<uint64_t>(n));
     }
     node node::operator[](unsigned long long n) const {
-        return operator[](std::to_string(n));
+        return get_numeric_child(n);
     }
     node node::operator[](signed long long n) const {
-        return operator[](std::to_string(n));
+        return n < 0 ? operator[](std::to_string(n)) : get_numeric_child(static_cast<uint64_t>(n));
     }
     node node::operator[](std::string const & o) const {
         return get_child(o.c_str(), static_cast<uint16_t>(o.length()));
@@ -95,7 +102,12 @@ namespace nl {
     node node::operator[](char const * o) const {
         return get_child(o, static_cast<uint16_t>(std::strlen(o)));
     }
+    node node::operator[](string_view o) const {
+        return get_child(o.data(), static_cast<uint16_t>(o.length()));
+    }
     node node::operator[](node const & o) const {
+        if (o.data_type() == type::string)
+            return operator[](o.get_string_view());
         return operator[](o.get_string());
     }
     node::operator unsigned char() const {
@@ -209,6 +221,11 @@ namespace nl {
             throw std::runtime_error("Unknown node type");
         }
     }
+    string_view node::get_string_view(string_view def) const {
+        if (m_data && m_data->type == type::string)
+            return to_string_view();
+        return def;
+    }
     vector2i node::get_vector(vector2i def) const {
         if (m_data && m_data->type == type::vector)
             return to_vector();
@@ -237,6 +254,9 @@ namespace nl {
         return m_data && m_data->type == type::vector ? m_data->vector[1] : 0;
     }
     std::string node::name() const {
+        return static_cast<std::string>(name_view());
+    }
+    string_view node::name_view() const {
         if (!m_data)
             return {};
         auto const s = reinterpret_cast<char const *>(m_file->base)
@@ -252,6 +272,9 @@ namespace nl {
     node node::get_child(char const * const o, uint16_t const l) const {
         if (!m_data)
             return {nullptr, m_file};
+#ifdef NLNX_STATS
+        stats::_access(*this);
+#endif
         auto p = m_file->node_table + m_data->children;
         auto n = m_data->num;
         auto const b = reinterpret_cast<const char *>(m_file->base);
@@ -289,6 +312,89 @@ namespace nl {
                 return {p2, m_file};
         }
     }
+    namespace {
+        //Tables which map the numeric names of a node's children to the children
+        //A table is only usable if the numbers are dense enough to be stored in an array
+        //Tables are kept for the whole session and each thread keeps its own index of them
+        //That memory is accepted, but it is only spent on parents with more children than this
+        //Smaller ones are searched by name, which takes only a few comparisons
+        uint16_t const numeric_table_min = 16;
+        struct numeric_table {
+            std::vector<uint32_t> children;
+            bool usable = false;
+        };
+        class numeric_tables {
+        public:
+            //Tables are never removed once built, so each thread remembers the ones it has seen
+            //and only takes the lock the first time it looks at a node
+            numeric_table const & get(node::data const * parent, node::data const * first, char const * base, uint64_t const * strings) {
+                thread_local std::unordered_map<node::data const *, numeric_table const *> seen;
+                auto const it = seen.find(parent);
+                if (it != seen.end())
+                    return *it->second;
+                auto const & table = build(parent, first, base, strings);
+                seen.emplace(parent, &table);
+                return table;
+            }
+        private:
+            numeric_table const & build(node::data const * parent, node::data const * first, char const * base, uint64_t const * strings) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto const it = m_tables.find(parent);
+                if (it != m_tables.end())
+                    return it->second;
+                auto & table = m_tables[parent];
+                auto const num = parent->num;
+                auto const limit = 2u * num + 64u;
+                std::vector<std::pair<uint32_t, uint32_t>> found;
+                for (uint32_t i = 0; i < num; ++i) {
+                    auto const sl = base + strings[first[i].name];
+                    auto const l = *reinterpret_cast<uint16_t const *>(sl);
+                    auto const str = sl + 2;
+                    //Only canonical names such as "0" or "12" are numeric, "012" is not
+                    if (!l || (l > 1 && str[0] == '0'))
+                        continue;
+                    uint32_t value = 0;
+                    bool digits = true;
+                    for (auto j = 0u; j < l && digits; ++j) {
+                        digits = str[j] >= '0' && str[j] <= '9';
+                        value = value * 10 + static_cast<uint32_t>(str[j] - '0');
+                    }
+                    if (!digits)
+                        continue;
+                    //Numbers which do not fit the array can only be found by name
+                    if (l > 9 || value >= limit)
+                        return table;
+                    found.emplace_back(value, i);
+                }
+                table.usable = true;
+                for (auto & f : found) {
+                    if (f.first >= table.children.size())
+                        table.children.resize(f.first + 1);
+                    table.children[f.first] = f.second + 1;
+                }
+                return table;
+            }
+            std::unordered_map<node::data const *, numeric_table> m_tables;
+            std::mutex m_mutex;
+        } numeric_children;
+    }
+    node node::get_numeric_child(uint64_t n) const {
+        if (!m_data)
+            return {nullptr, m_file};
+        if (m_data->num <= numeric_table_min)
+            return operator[](std::to_string(n));
+        auto const first = m_file->node_table + m_data->children;
+        auto const & table = numeric_children.get(m_data, first,
+            reinterpret_cast<char const *>(m_file->base), m_file->string_table);
+        if (!table.usable)
+            return operator[](std::to_string(n));
+#ifdef NLNX_STATS
+        stats::_access(*this);
+#endif
+        if (n >= table.children.size() || !table.children[n])
+            return {nullptr, m_file};
+        return {first + table.children[n] - 1, m_file};
+    }
     int64_t node::to_integer() const {
         return m_data->ireal;
     }
@@ -296,6 +402,9 @@ namespace nl {
         return m_data->dreal;
     }
     std::string node::to_string() const {
+        return static_cast<std::string>(to_string_view());
+    }
+    string_view node::to_string_view() const {
         auto const s = reinterpret_cast<char const *>(m_file->base)
             + m_file->string_table[m_data->string];
         return {s + 2, *reinterpret_cast<uint16_t const *>(s)};
@@ -316,16 +425,131 @@ namespace nl {
     node node::root() const {
         return {m_file->node_table, m_file};
     }
-    node node::resolve(std::string path) const {
-        std::istringstream stream(path);
-        std::vector<std::string> parts;
-        std::string segment;
-        while (std::getline(stream, segment, '/'))
-            parts.push_back(segment);
+    node node::resolve(std::string p) const {
+        return resolve(p.c_str());
+    }
+    node node::resolve(char const * p) const {
         auto n = *this;
-        for (auto & part : parts) {
-            n = n[part];
+        for (;;) {
+            auto const e = std::strchr(p, '/');
+            if (!e) {
+                if (*p)
+                    n = n.get_child(p, static_cast<uint16_t>(std::strlen(p)));
+                return n;
+            }
+            n = n.get_child(p, static_cast<uint16_t>(e - p));
+            p = e + 1;
         }
+    }
+    node node::resolve(path const & p) const {
+        auto n = *this;
+        for (size_t i = 0; i < p.size(); ++i) {
+            auto const & segment = p[i];
+            n = n.get_child(segment.c_str(), static_cast<uint16_t>(segment.length()));
+        }
+        return n;
+    }
+    void node::prefetch() const {
+        if (!m_data)
+            return;
+        auto const b = reinterpret_cast<char const *>(m_file->base);
+        auto const page = uintptr_t(0x1000);
+        std::vector<std::pair<uintptr_t, uintptr_t>> ranges;
+        auto add = [&](void const * p, size_t length) {
+            auto const first = reinterpret_cast<uintptr_t>(p);
+            ranges.emplace_back(first & ~(page - 1), (first + length + page - 1) & ~(page - 1));
+        };
+        auto add_string = [&](uint32_t id) {
+            auto const s = b + m_file->string_table[id];
+            add(s, 2u + *reinterpret_cast<uint16_t const *>(s));
+        };
+        std::vector<data const *> stack{m_data};
+        add(m_data, sizeof(data));
+        while (!stack.empty()) {
+            auto const d = stack.back();
+            stack.pop_back();
+            add_string(d->name);
+            switch (d->type) {
+            case type::string:
+                add_string(d->string);
+                break;
+            case type::bitmap:
+                if (m_file->header->bitmap_count) {
+                    auto const p = b + m_file->bitmap_table[d->bitmap.index];
+                    add(p, 4u + *reinterpret_cast<uint32_t const *>(p));
+                }
+                break;
+            case type::audio:
+                if (m_file->header->audio_count)
+                    add(b + m_file->audio_table[d->audio.index], d->audio.length);
+                break;
+            default:
+                break;
+            }
+            if (!d->num)
+                continue;
+            auto const children = m_file->node_table + d->children;
+            add(children, d->num * sizeof(data));
+            for (auto i = 0u; i < d->num; ++i)
+                stack.push_back(children + i);
+        }
+        std::sort(ranges.begin(), ranges.end());
+        auto first = ranges.front().first;
+        auto last = ranges.front().second;
+        for (auto & r : ranges) {
+            if (r.first > last) {
+                _prefetch(reinterpret_cast<void const *>(first), last - first);
+                first = r.first;
+            }
+            if (r.second > last)
+                last = r.second;
+        }
+        _prefetch(reinterpret_cast<void const *>(first), last - first);
+    }
+    namespace {
+        //Least recently used cache for resolve_cached
+        class resolve_cache {
+        public:
+            typedef std::pair<void const *, std::string> key;
+            bool find(key const & k, node & n) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto const it = m_index.find(k);
+                if (it == m_index.end())
+                    return false;
+                m_entries.splice(m_entries.begin(), m_entries, it->second);
+                n = it->second->second;
+                return true;
+            }
+            void insert(key const & k, node n) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_index.count(k))
+                    return;
+                m_entries.emplace_front(k, n);
+                m_index.emplace(k, m_entries.begin());
+                if (m_entries.size() > capacity) {
+                    m_index.erase(m_entries.back().first);
+                    m_entries.pop_back();
+                }
+            }
+        private:
+            struct hash {
+                size_t operator()(key const & k) const {
+                    return std::hash<void const *>()(k.first) ^ std::hash<std::string>()(k.second);
+                }
+            };
+            static size_t const capacity = 0x1000;
+            std::list<std::pair<key, node>> m_entries;
+            std::unordered_map<key, std::list<std::pair<key, node>>::iterator, hash> m_index;
+            std::mutex m_mutex;
+        } cached_paths;
+    }
+    node node::resolve_cached(std::string const & p) const {
+        auto const k = resolve_cache::key(m_data, p);
+        node n;
+        if (cached_paths.find(k, n))
+            return n;
+        n = resolve(p.c_str());
+        cached_paths.insert(k, n);
         return n;
     }
 }
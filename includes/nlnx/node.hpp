@@ -18,6 +18,7 @@
 
 #pragma once
 #include "nxfwd.hpp"
+#include "string_view.hpp"
 #include <string>
 #include <cstdint>
 #include <cstddef>
@@ -63,9 +64,12 @@ namespace nl {
         //then the node becomes invalid and this operator cannot tell you that
         explicit operator bool() const;
         //Methods to access the children of the node by name
-        //Note that the versions taking integers convert the integer to a string
+        //Note that the versions taking integers look up the child whose name is that integer
         //They do not access the children by their integer index
         //If you wish to do that, use somenode.begin() + integer_index
+        //Integer lookups on nodes with more than a few children use a table of numeric children
+        //which is built the first time the node is indexed by an integer and kept until exit,
+        //so repeated lookups avoid any string work
         node operator[](unsigned int) const;
         node operator[](signed int) const;
         node operator[](unsigned long) const;
@@ -74,6 +78,7 @@ namespace nl {
         node operator[](signed long long) const;
         node operator[](std::string const &) const;
         node operator[](char const *) const;
+        node operator[](string_view) const;
         //This method uses the string value of the node, not the node's name
         node operator[](node const &) const;
         //Operators to easily cast a node to get the data
@@ -104,6 +109,10 @@ namespace nl {
         int64_t get_integer(int64_t = 0) const;
         double get_real(double = 0) const;
         std::string get_string(std::string = "") const;
+        //Returns a view of the string value without copying it out of the file
+        //Unlike get_string, other data types are not converted and give the default value instead
+        //The view stays valid for as long as the file is open
+        string_view get_string_view(string_view = {}) const;
         vector2i get_vector(vector2i = {0, 0}) const;
         bitmap get_bitmap() const;
         audio get_audio() const;
@@ -114,6 +123,8 @@ namespace nl {
         int32_t y() const;
         //The name of the node
         std::string name() const;
+        //A view of the name of the node, which stays valid for as long as the file is open
+        string_view name_view() const;
         //The number of children in the node
         size_t size() const;
         //Gets the type of data contained within the node
@@ -122,12 +133,24 @@ namespace nl {
         node root() const;
         //Takes a '/' separated string, and resolves the given path
         node resolve(std::string) const;
+        node resolve(char const *) const;
+        //Resolves a path which was split ahead of time
+        node resolve(path const &) const;
+        //Same as resolve, but remembers recently resolved paths in a small LRU cache
+        //The cache is keyed by both this node and the path, and is safe to use from any thread
+        node resolve_cached(std::string const &) const;
+        //Asks the operating system to start reading this node and all of its descendants
+        //into memory, including their strings, bitmaps and audio
+        //Walking the subtree touches the node table, so call this from a background thread
+        void prefetch() const;
     private:
         node(data const *, _file_data const *);
         node get_child(char const *, uint16_t) const;
+        node get_numeric_child(uint64_t) const;
         int64_t to_integer() const;
         double to_real() const;
         std::string to_string() const;
+        string_view to_string_view() const;
         vector2i to_vector() const;
         bitmap to_bitmap() const;
         audio to_audio() const;
@@ -18,61 +18,163 @@
 #include "nx.hpp"
 #include "file.hpp"
 #include "node.hpp"
+#include "stats.hpp"
+#include <algorithm>
+#include <chrono>
 #include <fstream>
-#include <vector>
+#include <map>
 #include <memory>
 #include <stdexcept>
 namespace nl {
     namespace nx {
-        std::vector<std::unique_ptr<file>> files;
+        std::map<std::string, std::unique_ptr<file>> files;
+        std::vector<open_info> infos;
+        std::mutex files_mutex;
         bool exists(std::string name) {
             return std::ifstream(name).is_open();
         }
-        node add_file(std::string name) {
-            if (!exists(name))
-                return {};
-            files.emplace_back(new file(name));
-            return *files.back();
+        node open_file(std::string const & name) {
+            std::lock_guard<std::mutex> lock(files_mutex);
+            auto const it = files.find(name);
+            if (it != files.end())
+                return it->second->root();
+            auto const start = std::chrono::steady_clock::now();
+            std::unique_ptr<file> f;
+            std::string error;
+            try {
+                f.reset(new file(name));
+            } catch (std::exception const & e) {
+                error = e.what();
+            }
+            std::chrono::duration<double, std::milli> const elapsed = std::chrono::steady_clock::now() - start;
+            for (auto & info : infos) {
+                if (info.name == name) {
+                    info.opened = f != nullptr;
+                    info.milliseconds = elapsed.count();
+                    info.error = error;
+                }
+            }
+            //A file which can not be opened is as fatal as it was when all files were opened up front
+            if (!f)
+                throw std::runtime_error("Failed to open " + name + ": " + error);
+            return files.emplace(name, std::move(f)).first->second->root();
+        }
+        node lazy_node::get() const {
+            std::call_once(m_once, [this] {
+                if (m_filename.empty())
+                    return;
+                m_node = open_file(m_filename);
+                if (!m_child.empty())
+                    m_node = m_node[m_child];
+            });
+            return m_node;
+        }
+        lazy_node::operator node() const {
+            return get();
+        }
+        node lazy_node::begin() const {
+            return get().begin();
+        }
+        node lazy_node::end() const {
+            return get().end();
+        }
+        size_t lazy_node::size() const {
+            return get().size();
         }
-        node base, character, effect, etc, item, map, mob, morph, npc, quest, reactor, skill, sound, string, tamingmob, ui;
+        node lazy_node::resolve(std::string const & p) const {
+            return get().resolve(p);
+        }
+        node lazy_node::resolve_cached(std::string const & p) const {
+            return get().resolve_cached(p);
+        }
+        lazy_node base, character, effect, etc, item, map, mob, morph, npc, quest, reactor, skill, sound, string, tamingmob, ui;
         void load_all() {
+            auto bind = [](lazy_node & n, std::string filename, std::string child) {
+                n.m_filename = filename;
+                n.m_child = child;
+                for (auto & info : infos)
+                    if (info.name == filename)
+                        return;
+                infos.push_back({filename, false, 0, ""});
+            };
             if (exists("Base.nx")) {
-                base = add_file("Base.nx");
-                character = add_file("Character.nx");
-                effect = add_file("Effect.nx");
-                etc = add_file("Etc.nx");
-                item = add_file("Item.nx");
-                map = add_file("Map.nx");
-                mob = add_file("Mob.nx");
-                morph = add_file("Morph.nx");
-                npc = add_file("Npc.nx");
-                quest = add_file("Quest.nx");
-                reactor = add_file("Reactor.nx");
-                skill = add_file("Skill.nx");
-                sound = add_file("Sound.nx");
-                string = add_file("String.nx");
-                tamingmob = add_file("TamingMob.nx");
-                ui = add_file("UI.nx");
+                bind(base, "Base.nx", "");
+                bind(character, "Character.nx", "");
+                bind(effect, "Effect.nx", "");
+                bind(etc, "Etc.nx", "");
+                bind(item, "Item.nx", "");
+                bind(map, "Map.nx", "");
+                bind(mob, "Mob.nx", "");
+                bind(morph, "Morph.nx", "");
+                bind(npc, "Npc.nx", "");
+                bind(quest, "Quest.nx", "");
+                bind(reactor, "Reactor.nx", "");
+                bind(skill, "Skill.nx", "");
+                bind(sound, "Sound.nx", "");
+                bind(string, "String.nx", "");
+                bind(tamingmob, "TamingMob.nx", "");
+                bind(ui, "UI.nx", "");
             } else if (exists("Data.nx")) {
-                base = add_file("Data.nx");
-                character = base["Character"];
-                effect = base["Effect"];
-                etc = base["Etc"];
-                item = base["Item"];
-                map = base["Map"];
-                mob = base["Mob"];
-                morph = base["Morph"];
-                npc = base["Npc"];
-                quest = base["Quest"];
-                reactor = base["Reactor"];
-                skill = base["Skill"];
-                sound = base["Sound"];
-                string = base["String"];
-                tamingmob = base["TamingMob"];
-                ui = base["UI"];
+                bind(base, "Data.nx", "");
+                bind(character, "Data.nx", "Character");
+                bind(effect, "Data.nx", "Effect");
+                bind(etc, "Data.nx", "Etc");
+                bind(item, "Data.nx", "Item");
+                bind(map, "Data.nx", "Map");
+                bind(mob, "Data.nx", "Mob");
+                bind(morph, "Data.nx", "Morph");
+                bind(npc, "Data.nx", "Npc");
+                bind(quest, "Data.nx", "Quest");
+                bind(reactor, "Data.nx", "Reactor");
+                bind(skill, "Data.nx", "Skill");
+                bind(sound, "Data.nx", "Sound");
+                bind(string, "Data.nx", "String");
+                bind(tamingmob, "Data.nx", "TamingMob");
+                bind(ui, "Data.nx", "UI");
             } else {
                 throw std::runtime_error("Failed to locate nx files.");
             }
         }
+        std::vector<open_info> open_infos() {
+            std::lock_guard<std::mutex> lock(files_mutex);
+            return infos;
+        }
+        void write_stats(std::string const & filename, size_t count) {
+            if (!stats::enabled())
+                return;
+            std::vector<stats::image> images;
+            {
+                std::lock_guard<std::mutex> lock(files_mutex);
+                for (auto const & f : files)
+                    if (f.second)
+                        stats::collect(f.second->root(), f.first, images);
+            }
+            std::sort(images.begin(), images.end(), [](stats::image const & a, stats::image const & b) {
+                return a.accesses > b.accesses;
+            });
+            if (images.size() > count)
+                images.resize(count);
+            std::ofstream out(filename);
+            out << "accesses\tdecodes\tdecoded_bytes\tdecode_ms\timage\n";
+            for (auto const & img : images)
+                out << img.accesses << '\t' << img.decodes << '\t' << img.decoded_bytes << '\t'
+                    << img.decode_milliseconds << '\t' << img.path << '\n';
+        }
+        bool locate(void const * ptr, location & loc) {
+            std::lock_guard<std::mutex> lock(files_mutex);
+            auto const p = reinterpret_cast<char const *>(ptr);
+            for (auto const & f : files) {
+                if (!f.second)
+                    continue;
+                auto const b = reinterpret_cast<char const *>(f.second->base());
+                if (p < b || p >= b + f.second->size())
+                    continue;
+                loc.name = f.first;
+                loc.offset = static_cast<uint64_t>(p - b);
+                loc.digest = f.second->digest();
+                return true;
+            }
+            return false;
+        }
     }
 }
@@ -18,14 +18,71 @@
 
 #pragma once
 #include "nxfwd.hpp"
+#include "node.hpp"
+#include <mutex>
+#include <string>
+#include <vector>
 
 namespace nl {
     namespace nx {
+        //Refers to the root of an nx file, or a child of it, which is only opened when first accessed
+        //The file header is validated at that point, and std::runtime_error is thrown if the file cannot be opened
+        //The next access then tries to open it again
+        //Safe to access from multiple threads
+        class lazy_node {
+        public:
+            lazy_node() = default;
+            lazy_node(lazy_node const &) = delete;
+            lazy_node & operator=(lazy_node const &) = delete;
+            //Returns the node, opening the file if needed
+            node get() const;
+            operator node() const;
+            //Convenience methods which forward to the node
+            template <typename T>
+            node operator[](T const & key) const {
+                return get()[key];
+            }
+            node begin() const;
+            node end() const;
+            size_t size() const;
+            node resolve(std::string const &) const;
+            node resolve_cached(std::string const &) const;
+        private:
+            friend void load_all();
+            std::string m_filename;
+            std::string m_child;
+            mutable node m_node;
+            mutable std::once_flag m_once;
+        };
+        //How long opening each file took, for startup profiling
+        struct open_info {
+            std::string name;
+            bool opened;
+            double milliseconds;
+            //Why the file could not be opened, empty if it was opened or not accessed yet
+            std::string error;
+        };
         //Pre-defined nodes to access standard MapleStory style data
         //Make sure you called load_all first
-        extern node base, character, effect, etc, item, map, mob, morph, npc, quest, reactor, skill, sound, string, tamingmob, ui;
-        //Loads the pre-defined nodes from a standard setup of nx files for MapleStory
+        extern lazy_node base, character, effect, etc, item, map, mob, morph, npc, quest, reactor, skill, sound, string, tamingmob, ui;
+        //Locates the nx files of a standard MapleStory setup and binds the pre-defined nodes to them
+        //The files themselves are opened on first access
         //Only call this function once
         void load_all();
+        //Returns the open times of the files used by the pre-defined nodes
+        std::vector<open_info> open_infos();
+        //Where a pointer into one of the opened files points to
+        struct location {
+            std::string name;
+            uint64_t offset;
+            uint64_t digest;
+        };
+        //Writes the images of all opened files with the most node accesses to a text file
+        //together with how many bytes of bitmaps were decoded from them and how long that took
+        //Does nothing unless the library was built with NLNX_STATS
+        void write_stats(std::string const & filename, size_t count);
+        //Finds the opened file containing the given pointer, such as the id of a bitmap
+        //Returns false if no opened file contains it
+        bool locate(void const *, location &);
     }
 }
@@ -23,4 +23,5 @@ namespace nl {
     class file;
     class bitmap;
     class audio;
+    class path;
 }
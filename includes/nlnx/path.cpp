@@ -0,0 +1,60 @@
+//////////////////////////////////////////////////////////////////////////////
+// NoLifeNx - Part of the NoLifeStory project                               //
+// Copyright © 2013 Peter Atashian                                          //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+
+#include "path.hpp"
+#include <mutex>
+#include <unordered_set>
+
+namespace nl {
+    namespace {
+        //Elements of an unordered_set never move, so pointers to them stay valid
+        std::unordered_set<std::string> interned_segments;
+        std::mutex interned_mutex;
+        std::string const * intern(std::string && segment) {
+            std::lock_guard<std::mutex> lock(interned_mutex);
+            return &*interned_segments.insert(std::move(segment)).first;
+        }
+    }
+    path::path(std::string const & s) {
+        size_t first = 0;
+        while (first < s.size()) {
+            auto last = s.find('/', first);
+            if (last == std::string::npos)
+                last = s.size();
+            m_segments.push_back(intern(s.substr(first, last - first)));
+            first = last + 1;
+        }
+    }
+    path::path(char const * s) :
+        path(std::string(s)) {}
+    size_t path::size() const {
+        return m_segments.size();
+    }
+    std::string const & path::operator[](size_t i) const {
+        return *m_segments[i];
+    }
+    std::string path::str() const {
+        std::string s;
+        for (size_t i = 0; i < m_segments.size(); ++i) {
+            if (i)
+                s += '/';
+            s += *m_segments[i];
+        }
+        return s;
+    }
+}
@@ -0,0 +1,45 @@
+//////////////////////////////////////////////////////////////////////////////
+// NoLifeNx - Part of the NoLifeStory project                               //
+// Copyright © 2013 Peter Atashian                                          //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "nxfwd.hpp"
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace nl {
+    //A '/' separated path which is split once and whose segments are interned
+    //Resolving a path object does no string allocation or splitting
+    //Useful for paths which are resolved over and over again
+    class path {
+    public:
+        path() = default;
+        path(path const &) = default;
+        path & operator=(path const &) = default;
+        path(std::string const &);
+        path(char const *);
+        //The number of segments in the path
+        size_t size() const;
+        //Returns the segment with the given index
+        std::string const & operator[](size_t) const;
+        //Joins the segments back together with '/'
+        std::string str() const;
+    private:
+        std::vector<std::string const *> m_segments;
+    };
+}
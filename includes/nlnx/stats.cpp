@@ -0,0 +1,97 @@
+//////////////////////////////////////////////////////////////////////////////
+// NoLifeNx - Part of the NoLifeStory project                               //
+// Copyright © 2013 Peter Atashian                                          //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+
+#include "stats.hpp"
+#include "node.hpp"
+#include "bitmap.hpp"
+#include <map>
+#include <mutex>
+
+namespace nl {
+    namespace stats {
+#ifdef NLNX_STATS
+        namespace {
+            struct decode_totals {
+                uint64_t count = 0;
+                uint64_t bytes = 0;
+                double milliseconds = 0;
+            };
+            std::map<node, uint64_t> accesses;
+            std::map<size_t, decode_totals> decodes;
+            std::mutex mutex;
+            bool is_image(std::string const & name) {
+                return name.size() > 4 && name.compare(name.size() - 4, 4, ".img") == 0;
+            }
+            void sum(node const & n, image & img) {
+                auto const a = accesses.find(n);
+                if (a != accesses.end())
+                    img.accesses += a->second;
+                if (n.data_type() == node::type::bitmap) {
+                    auto const d = decodes.find(n.get_bitmap().id());
+                    if (d != decodes.end()) {
+                        img.decodes += d->second.count;
+                        img.decoded_bytes += d->second.bytes;
+                        img.decode_milliseconds += d->second.milliseconds;
+                    }
+                }
+                for (auto const & c : n)
+                    sum(c, img);
+            }
+            void find_images(node const & n, std::string const & path, std::vector<image> & out) {
+                for (auto const & c : n) {
+                    auto const name = c.name();
+                    auto const p = path.empty() ? name : path + '/' + name;
+                    if (is_image(name)) {
+                        image img{p, 0, 0, 0, 0};
+                        sum(c, img);
+                        if (img.accesses || img.decodes)
+                            out.push_back(img);
+                    } else {
+                        find_images(c, p, out);
+                    }
+                }
+            }
+        }
+        bool enabled() {
+            return true;
+        }
+        void collect(node const & root, std::string const & prefix, std::vector<image> & out) {
+            std::lock_guard<std::mutex> lock(mutex);
+            find_images(root, prefix, out);
+        }
+        void _access(node const & n) {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++accesses[n];
+        }
+        void _decode(bitmap const & b, double milliseconds) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto & d = decodes[b.id()];
+            ++d.count;
+            d.bytes += b.length();
+            d.milliseconds += milliseconds;
+        }
+#else
+        bool enabled() {
+            return false;
+        }
+        void collect(node const &, std::string const &, std::vector<image> &) {}
+        void _access(node const &) {}
+        void _decode(bitmap const &, double) {}
+#endif
+    }
+}
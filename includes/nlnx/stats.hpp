@@ -0,0 +1,47 @@
+//////////////////////////////////////////////////////////////////////////////
+// NoLifeNx - Part of the NoLifeStory project                               //
+// Copyright © 2013 Peter Atashian                                          //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "nxfwd.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//Define NLNX_STATS when building the library to record which nodes and bitmaps are accessed
+//Without it the hooks are compiled out and the functions below return nothing
+namespace nl {
+    namespace stats {
+        //Totals for one .img subtree
+        struct image {
+            std::string path;
+            uint64_t accesses;
+            uint64_t decodes;
+            uint64_t decoded_bytes;
+            double decode_milliseconds;
+        };
+        //Whether the library was built with NLNX_STATS
+        bool enabled();
+        //Adds the totals of every .img below the given node to out
+        //The paths are relative to the node and start with the given prefix
+        //Walks the whole subtree, so only call this when writing a report
+        void collect(node const & root, std::string const & prefix, std::vector<image> & out);
+        //Hooks used by node and bitmap when NLNX_STATS is defined
+        void _access(node const &);
+        void _decode(bitmap const &, double milliseconds);
+    }
+}
@@ -0,0 +1,82 @@
+//////////////////////////////////////////////////////////////////////////////
+// NoLifeNx - Part of the NoLifeStory project                               //
+// Copyright © 2013 Peter Atashian                                          //
+//                                                                          //
+// This program is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU Affero General Public License as           //
+// published by the Free Software Foundation, either version 3 of the       //
+// License, or (at your option) any later version.                          //
+//                                                                          //
+// This program is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of           //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            //
+// GNU Affero General Public License for more details.                      //
+//                                                                          //
+// You should have received a copy of the GNU Affero General Public License //
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.    //
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace nl {
+    //A view of a string which it does not own, such as one in the string table of a mapped file
+    //Has the subset of the std::string_view interface used with nx data
+    //so that the library does not need C++17
+    class string_view {
+    public:
+        string_view() = default;
+        string_view(string_view const &) = default;
+        string_view & operator=(string_view const &) = default;
+        string_view(char const * s, size_t n) : m_data(s), m_size(n) {}
+        string_view(char const * s) : m_data(s), m_size(std::strlen(s)) {}
+        string_view(std::string const & s) : m_data(s.data()), m_size(s.size()) {}
+        char const * data() const {
+            return m_data;
+        }
+        size_t size() const {
+            return m_size;
+        }
+        size_t length() const {
+            return m_size;
+        }
+        bool empty() const {
+            return m_size == 0;
+        }
+        char const * begin() const {
+            return m_data;
+        }
+        char const * end() const {
+            return m_data + m_size;
+        }
+        char operator[](size_t i) const {
+            return m_data[i];
+        }
+        char front() const {
+            return m_data[0];
+        }
+        int compare(string_view o) const {
+            auto const r = m_size && o.m_size ? std::memcmp(m_data, o.m_data, std::min(m_size, o.m_size)) : 0;
+            return r ? r : m_size < o.m_size ? -1 : m_size > o.m_size ? 1 : 0;
+        }
+        //Copies the viewed characters into a new string
+        explicit operator std::string() const {
+            return {m_data, m_size};
+        }
+    private:
+        char const * m_data = nullptr;
+        size_t m_size = 0;
+    };
+    inline bool operator==(string_view a, string_view b) {
+        return a.size() == b.size() && a.compare(b) == 0;
+    }
+    inline bool operator!=(string_view a, string_view b) {
+        return !(a == b);
+    }
+    inline bool operator<(string_view a, string_view b) {
+        return a.compare(b) < 0;
+    }
+}